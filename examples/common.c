@@ -33,6 +33,7 @@
 #include <libdivecomputer/irda.h>
 #include <libdivecomputer/usb.h>
 #include <libdivecomputer/usbhid.h>
+#include <libdivecomputer/replay.h>
 
 #include "common.h"
 #include "utils.h"
@@ -56,6 +57,9 @@ typedef struct transport_table_t {
 	dc_transport_t type;
 } transport_table_t;
 
+static const char *g_replay = NULL;
+static unsigned int g_replay_flags = 0;
+
 static const backend_table_t g_backends[] = {
 	{"solution",    DC_FAMILY_SUUNTO_SOLUTION,     0},
 	{"eon",	        DC_FAMILY_SUUNTO_EON,          0},
@@ -570,9 +574,21 @@ cleanup:
 	return status;
 }
 
+void
+dctool_iostream_set_replay (const char *filename, unsigned int flags)
+{
+	g_replay = filename;
+	g_replay_flags = flags;
+}
+
 dc_status_t
 dctool_iostream_open (dc_iostream_t **iostream, dc_context_t *context, dc_descriptor_t *descriptor, dc_transport_t transport, const char *devname)
 {
+	// Replay a recorded session instead of opening the real device.
+	if (g_replay) {
+		return dc_replay_open (iostream, context, g_replay, g_replay_flags);
+	}
+
 	switch (transport) {
 	case DC_TRANSPORT_SERIAL:
 		return dc_serial_open (iostream, context, devname);
@@ -37,6 +37,7 @@
 
 #include <libdivecomputer/context.h>
 #include <libdivecomputer/descriptor.h>
+#include <libdivecomputer/replay.h>
 
 #include "common.h"
 #include "dctool.h"
@@ -66,6 +67,7 @@ static const dctool_command_t *g_commands[] = {
 	&dctool_write,
 	&dctool_timesync,
 	&dctool_fwupdate,
+	&dctool_trace,
 	NULL
 };
 
@@ -111,6 +113,9 @@ dctool_command_showhelp (const dctool_command_t *command)
 			"   -f, --family <family>     Device family type\n"
 			"   -m, --model <model>       Device model number\n"
 			"   -l, --logfile <logfile>   Logfile\n"
+			"   -T, --tracefile <file>    Binary trace file\n"
+			"   -R, --replay <file>       Replay a trace file\n"
+			"   -P, --replay-timing       Replay with the original timing\n"
 			"   -q, --quiet               Quiet mode\n"
 			"   -v, --verbose             Verbose mode\n"
 #else
@@ -119,6 +124,9 @@ dctool_command_showhelp (const dctool_command_t *command)
 			"   -f <family>    Family type\n"
 			"   -m <model>     Model number\n"
 			"   -l <logfile>   Logfile\n"
+			"   -T <file>      Binary trace file\n"
+			"   -R <file>      Replay a trace file\n"
+			"   -P             Replay with the original timing\n"
 			"   -q             Quiet mode\n"
 			"   -v             Verbose mode\n"
 #endif
@@ -174,6 +182,9 @@ main (int argc, char *argv[])
 	unsigned int help = 0;
 	dc_loglevel_t loglevel = DC_LOGLEVEL_WARNING;
 	const char *logfile = NULL;
+	const char *tracefile = NULL;
+	const char *replay = NULL;
+	unsigned int replay_flags = 0;
 	const char *device = NULL;
 	dc_family_t family = DC_FAMILY_NULL;
 	unsigned int model = 0;
@@ -181,7 +192,7 @@ main (int argc, char *argv[])
 
 	// Parse the command-line options.
 	int opt = 0;
-	const char *optstring = NOPERMUTATION "hd:f:m:l:qv";
+	const char *optstring = NOPERMUTATION "hd:f:m:l:T:R:Pqv";
 #ifdef HAVE_GETOPT_LONG
 	struct option options[] = {
 		{"help",        no_argument,       0, 'h'},
@@ -189,6 +200,9 @@ main (int argc, char *argv[])
 		{"family",      required_argument, 0, 'f'},
 		{"model",       required_argument, 0, 'm'},
 		{"logfile",     required_argument, 0, 'l'},
+		{"tracefile",   required_argument, 0, 'T'},
+		{"replay",      required_argument, 0, 'R'},
+		{"replay-timing", no_argument,     0, 'P'},
 		{"quiet",       no_argument,       0, 'q'},
 		{"verbose",     no_argument,       0, 'v'},
 		{0,             0,                 0,  0 }
@@ -215,6 +229,15 @@ main (int argc, char *argv[])
 		case 'l':
 			logfile = optarg;
 			break;
+		case 'T':
+			tracefile = optarg;
+			break;
+		case 'R':
+			replay = optarg;
+			break;
+		case 'P':
+			replay_flags |= DC_REPLAY_TIMING;
+			break;
 		case 'q':
 			loglevel = DC_LOGLEVEL_NONE;
 			break;
@@ -277,6 +300,19 @@ main (int argc, char *argv[])
 	dc_context_set_loglevel (context, loglevel);
 	dc_context_set_logfunc (context, logfunc, NULL);
 
+	// Setup the replay of a recorded session.
+	dctool_iostream_set_replay (replay, replay_flags);
+
+	// Setup the binary trace.
+	if (tracefile) {
+		status = dc_context_set_tracefile (context, tracefile);
+		if (status != DC_STATUS_SUCCESS) {
+			message ("Failed to open the trace file.\n");
+			exitcode = EXIT_FAILURE;
+			goto cleanup;
+		}
+	}
+
 	if (device != NULL || family != DC_FAMILY_NULL) {
 		// Search for a matching device descriptor.
 		status = dctool_descriptor_search (&descriptor, device, family, model);
@@ -48,6 +48,7 @@ typedef struct event_data_t {
 
 typedef struct dive_data_t {
 	dc_device_t *device;
+	dc_parser_t *parser;
 	dc_buffer_t **fingerprint;
 	unsigned int number;
 	dctool_output_t *output;
@@ -58,7 +59,6 @@ dive_cb (const unsigned char *data, unsigned int size, const unsigned char *fing
 {
 	dive_data_t *divedata = (dive_data_t *) userdata;
 	dc_status_t rc = DC_STATUS_SUCCESS;
-	dc_parser_t *parser = NULL;
 
 	divedata->number++;
 
@@ -76,17 +76,20 @@ dive_cb (const unsigned char *data, unsigned int size, const unsigned char *fing
 		*divedata->fingerprint = fp;
 	}
 
-	// Create the parser.
-	message ("Creating the parser.\n");
-	rc = dc_parser_new (&parser, divedata->device);
-	if (rc != DC_STATUS_SUCCESS) {
-		ERROR ("Error creating the parser.");
-		goto cleanup;
+	// Create the parser. The parser is created only once, and re-used
+	// for all the other dives.
+	if (divedata->parser == NULL) {
+		message ("Creating the parser.\n");
+		rc = dc_parser_new (&divedata->parser, divedata->device);
+		if (rc != DC_STATUS_SUCCESS) {
+			ERROR ("Error creating the parser.");
+			goto cleanup;
+		}
 	}
 
 	// Register the data.
 	message ("Registering the data.\n");
-	rc = dc_parser_set_data (parser, data, size);
+	rc = dc_parser_set_data (divedata->parser, data, size);
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR ("Error registering the data.");
 		goto cleanup;
@@ -94,14 +97,14 @@ dive_cb (const unsigned char *data, unsigned int size, const unsigned char *fing
 
 	// Parse the dive data.
 	message ("Parsing the dive data.\n");
-	rc = dctool_output_write (divedata->output, parser, data, size, fingerprint, fsize);
+	rc = dctool_output_write (divedata->output, divedata->parser, data, size, fingerprint, fsize);
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR ("Error parsing the dive data.");
 		goto cleanup;
 	}
 
 cleanup:
-	dc_parser_destroy (parser);
+	dc_parser_reset (divedata->parser);
 	return 1;
 }
 
@@ -217,6 +220,7 @@ download (dc_context_t *context, dc_descriptor_t *descriptor, dc_transport_t tra
 	// Initialize the dive data.
 	dive_data_t divedata = {0};
 	divedata.device = device;
+	divedata.parser = NULL;
 	divedata.fingerprint = &ofingerprint;
 	divedata.number = 0;
 	divedata.output = output;
@@ -224,6 +228,7 @@ download (dc_context_t *context, dc_descriptor_t *descriptor, dc_transport_t tra
 	// Download the dives.
 	message ("Downloading the dives.\n");
 	rc = dc_device_foreach (device, dive_cb, &divedata);
+	dc_parser_destroy (divedata.parser);
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR ("Error downloading the dives.");
 		goto cleanup;
@@ -0,0 +1,246 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+
+#include <libdivecomputer/context.h>
+#include <libdivecomputer/descriptor.h>
+
+#include "dctool.h"
+#include "common.h"
+#include "utils.h"
+
+#define HEADERSIZE 8
+#define RECORDSIZE 20
+
+static unsigned int
+uint32_le (const unsigned char data[])
+{
+	return ((unsigned int) data[0] <<  0) |
+	       ((unsigned int) data[1] <<  8) |
+	       ((unsigned int) data[2] << 16) |
+	       ((unsigned int) data[3] << 24);
+}
+
+static const char *
+trace_type_name (unsigned int type)
+{
+	switch (type) {
+	case DC_TRACE_READ:
+		return "Read";
+	case DC_TRACE_WRITE:
+		return "Write";
+	case DC_TRACE_IOCTL_READ:
+		return "Ioctl read";
+	case DC_TRACE_IOCTL_WRITE:
+		return "Ioctl write";
+	default:
+		return "Unknown";
+	}
+}
+
+static int
+decode (FILE *ifp, FILE *ofp, unsigned int verbose)
+{
+	unsigned char header[RECORDSIZE];
+	unsigned char *data = NULL;
+	unsigned int capacity = 0;
+	unsigned int count = 0;
+
+	if (fread (header, HEADERSIZE, 1, ifp) != 1 ||
+		memcmp (header, "DCTR", 4) != 0) {
+		message ("Not a trace file.\n");
+		return -1;
+	}
+
+	unsigned int version = uint32_le (header + 4);
+	if (version != 1) {
+		message ("Unsupported trace file version (%u).\n", version);
+		return -1;
+	}
+
+	while (fread (header, RECORDSIZE, 1, ifp) == 1) {
+		unsigned long long timestamp =
+			(unsigned long long) uint32_le (header + 4) << 32 |
+			uint32_le (header + 0);
+		unsigned int size = uint32_le (header + 8);
+		unsigned int request = uint32_le (header + 12);
+		unsigned int transport = header[16] | (header[17] << 8);
+		unsigned int type = header[18];
+		dc_status_t status = (dc_status_t) (signed char) header[19];
+
+		if (size > capacity) {
+			unsigned char *buffer = (unsigned char *) realloc (data, size);
+			if (buffer == NULL) {
+				message ("Failed to allocate memory.\n");
+				free (data);
+				return -1;
+			}
+			data = buffer;
+			capacity = size;
+		}
+
+		if (size && fread (data, size, 1, ifp) != 1) {
+			message ("Truncated trace record.\n");
+			break;
+		}
+
+		const char *transport_name = dctool_transport_name ((dc_transport_t) transport);
+		fprintf (ofp, "[%llu.%06llu] %-11s %-10s",
+			timestamp / 1000000, timestamp % 1000000,
+			trace_type_name (type),
+			transport_name ? transport_name : "unknown");
+		if (type == DC_TRACE_IOCTL_READ || type == DC_TRACE_IOCTL_WRITE) {
+			fprintf (ofp, " request=0x%08x", request);
+		}
+		if (status != DC_STATUS_SUCCESS || verbose) {
+			fprintf (ofp, " status=%s", dctool_errmsg (status));
+		}
+		fprintf (ofp, " size=%u data=", size);
+		for (unsigned int i = 0; i < size; ++i) {
+			fprintf (ofp, "%02X", data[i]);
+		}
+		fprintf (ofp, "\n");
+
+		count++;
+	}
+
+	free (data);
+
+	message ("Decoded %u records.\n", count);
+
+	return 0;
+}
+
+static int
+dctool_trace_run (int argc, char *argv[], dc_context_t *context, dc_descriptor_t *descriptor)
+{
+	int exitcode = EXIT_SUCCESS;
+	FILE *ifp = NULL, *ofp = NULL;
+
+	// Default option values.
+	unsigned int help = 0;
+	unsigned int verbose = 0;
+	const char *filename = NULL;
+
+	// Parse the command-line options.
+	int opt = 0;
+	const char *optstring = "ho:s";
+#ifdef HAVE_GETOPT_LONG
+	struct option options[] = {
+		{"help",        no_argument,       0, 'h'},
+		{"output",      required_argument, 0, 'o'},
+		{"status",      no_argument,       0, 's'},
+		{0,             0,                 0,  0 }
+	};
+	while ((opt = getopt_long (argc, argv, optstring, options, NULL)) != -1) {
+#else
+	while ((opt = getopt (argc, argv, optstring)) != -1) {
+#endif
+		switch (opt) {
+		case 'h':
+			help = 1;
+			break;
+		case 'o':
+			filename = optarg;
+			break;
+		case 's':
+			verbose = 1;
+			break;
+		default:
+			return EXIT_FAILURE;
+		}
+	}
+
+	argc -= optind;
+	argv += optind;
+
+	// Show help message.
+	if (help) {
+		dctool_command_showhelp (&dctool_trace);
+		return EXIT_SUCCESS;
+	}
+
+	if (argc < 1) {
+		message ("No trace file specified.\n");
+		return EXIT_FAILURE;
+	}
+
+	// Open the trace file.
+	ifp = fopen (argv[0], "rb");
+	if (ifp == NULL) {
+		message ("Failed to open the trace file.\n");
+		exitcode = EXIT_FAILURE;
+		goto cleanup;
+	}
+
+	// Open the output file.
+	if (filename) {
+		ofp = fopen (filename, "w");
+		if (ofp == NULL) {
+			message ("Failed to open the output file.\n");
+			exitcode = EXIT_FAILURE;
+			goto cleanup;
+		}
+	}
+
+	if (decode (ifp, ofp ? ofp : stdout, verbose) != 0) {
+		exitcode = EXIT_FAILURE;
+		goto cleanup;
+	}
+
+cleanup:
+	if (ofp)
+		fclose (ofp);
+	if (ifp)
+		fclose (ifp);
+	return exitcode;
+}
+
+const dctool_command_t dctool_trace = {
+	dctool_trace_run,
+	DCTOOL_CONFIG_NONE,
+	"trace",
+	"Decode a binary trace file",
+	"Usage:\n"
+	"   dctool trace [options] <filename>\n"
+	"\n"
+	"Options:\n"
+#ifdef HAVE_GETOPT_LONG
+	"   -h, --help                 Show help message\n"
+	"   -o, --output <filename>    Output filename\n"
+	"   -s, --status               Show the status of every record\n"
+#else
+	"   -h                 Show help message\n"
+	"   -o <filename>      Output filename\n"
+	"   -s                 Show the status of every record\n"
+#endif
+};
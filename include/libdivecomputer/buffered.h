@@ -0,0 +1,59 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_BUFFERED_H
+#define DC_BUFFERED_H
+
+#include "common.h"
+#include "context.h"
+#include "iostream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Create a buffered I/O stream.
+ *
+ * Whenever the internal buffer runs empty, all data that is already
+ * available in the underlying I/O stream (up to the size of the buffer)
+ * is read in a single operation, and subsequent reads are served from
+ * the buffer. If no data is available, the read is passed through
+ * unchanged. This reduces the number of system calls for protocols that
+ * read only a few bytes at a time. Writes and all other operations are
+ * passed through. The buffered stream takes ownership of the underlying
+ * I/O stream, and closes it when it is closed.
+ *
+ * @param[out]  iostream   A location to store the buffered I/O stream.
+ * @param[in]   context    A valid context object.
+ * @param[in]   base       The underlying I/O stream.
+ * @param[in]   size       The size of the buffer (in bytes), or zero to
+ *                         use the default size.
+ * @returns #DC_STATUS_SUCCESS on success, or another #dc_status_t code
+ * on failure.
+ */
+dc_status_t
+dc_buffered_open (dc_iostream_t **iostream, dc_context_t *context, dc_iostream_t *base, size_t size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_BUFFERED_H */
@@ -39,6 +39,13 @@ typedef enum dc_loglevel_t {
 	DC_LOGLEVEL_ALL
 } dc_loglevel_t;
 
+typedef enum dc_trace_t {
+	DC_TRACE_READ = 1,
+	DC_TRACE_WRITE = 2,
+	DC_TRACE_IOCTL_READ = 3,
+	DC_TRACE_IOCTL_WRITE = 4
+} dc_trace_t;
+
 typedef void (*dc_logfunc_t) (dc_context_t *context, dc_loglevel_t loglevel, const char *file, unsigned int line, const char *function, const char *message, void *userdata);
 
 dc_status_t
@@ -53,6 +60,38 @@ dc_context_set_loglevel (dc_context_t *context, dc_loglevel_t loglevel);
 dc_status_t
 dc_context_set_logfunc (dc_context_t *context, dc_logfunc_t logfunc, void *userdata);
 
+/*
+ * Deliver the log messages asynchronously from a background thread,
+ * through a queue with room for (at least) capacity messages. Messages
+ * that do not fit in the queue are dropped and counted. A capacity of
+ * zero flushes the queue and returns to synchronous delivery.
+ *
+ * This function must not be called while other threads are logging.
+ */
+dc_status_t
+dc_context_set_logqueue (dc_context_t *context, unsigned int capacity);
+
+/*
+ * Capture all data exchanged over the I/O streams of the context in a
+ * binary trace file. Passing a NULL filename stops the capture.
+ *
+ * The file starts with an 8 byte header: the magic "DCTR" and a 32 bit
+ * version number (currently 1). Every record has a 20 byte header,
+ * followed by the data:
+ *
+ *   offset  size  field
+ *        0     8  timestamp (microseconds since the context was created)
+ *        8     4  data size (in bytes)
+ *       12     4  ioctl request (zero for plain reads and writes)
+ *       16     2  transport (dc_transport_t)
+ *       18     1  type (dc_trace_t)
+ *       19     1  status (dc_status_t, signed)
+ *
+ * All values are stored in little endian byte order.
+ */
+dc_status_t
+dc_context_set_tracefile (dc_context_t *context, const char *filename);
+
 unsigned int
 dc_context_get_transports (dc_context_t *context);
 
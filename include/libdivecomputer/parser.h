@@ -53,6 +53,16 @@ typedef enum dc_sample_type_t {
 // Make it easy to test support compile-time with "#ifdef DC_SAMPLE_TTS"
 #define DC_SAMPLE_TTS DC_SAMPLE_TTS
 
+/*
+ * Sample mask
+ *
+ * A bitmask of the sample types a caller is interested in. Parsers skip
+ * the decoding of the unwanted sample types where possible, and they are
+ * never passed to the sample callback.
+ */
+#define DC_SAMPLE_MASK(type) (1u << (type))
+#define DC_SAMPLE_MASK_ALL 0xFFFFFFFFu
+
 typedef enum dc_field_type_t {
 	DC_FIELD_DIVETIME,
 	DC_FIELD_MAXDEPTH,
@@ -262,10 +272,121 @@ typedef union dc_sample_value_t {
 	unsigned int gasmix; /* Gas mix index */
 } dc_sample_value_t;
 
+/*
+ * Dive summary
+ *
+ * The values that are typically needed to show a dive in a logbook,
+ * retrieved with a single call. Parsers fill the summary from the dive
+ * header whenever possible, without decoding the samples. Only the
+ * values with their bit set in the fields member are available. The
+ * gas mix count only includes the gas mixes defined in the header, and
+ * can be lower than DC_FIELD_GASMIX_COUNT if additional gas mixes are
+ * only found in the profile.
+ */
+
+#define DC_SUMMARY_DATETIME     (1 << 0)
+#define DC_SUMMARY_DIVETIME     (1 << 1)
+#define DC_SUMMARY_MAXDEPTH     (1 << 2)
+#define DC_SUMMARY_AVGDEPTH     (1 << 3)
+#define DC_SUMMARY_DIVEMODE     (1 << 4)
+#define DC_SUMMARY_GASMIX_COUNT (1 << 5)
+#define DC_SUMMARY_TEMPERATURE  (1 << 6)
+#define DC_SUMMARY_SALINITY     (1 << 7)
+#define DC_SUMMARY_ATMOSPHERIC  (1 << 8)
+
+typedef struct dc_summary_t {
+	unsigned int fields;      /* Bitmask of the available values */
+	dc_datetime_t datetime;
+	unsigned int divetime;    /* Dive time (seconds) */
+	double maxdepth;          /* Maximum depth (meter) */
+	double avgdepth;          /* Average depth (meter) */
+	dc_divemode_t divemode;
+	unsigned int ngasmixes;
+	double temperature;       /* Minimum temperature (Celsius) */
+	dc_salinity_t salinity;
+	double atmospheric;       /* Atmospheric pressure (bar) */
+} dc_summary_t;
+
 typedef struct dc_parser_t dc_parser_t;
 
 typedef void (*dc_sample_callback_t) (dc_sample_type_t type, dc_sample_value_t value, void *userdata);
 
+/*
+ * Columnar sample batches
+ *
+ * Instead of receiving every sample value through a callback, the
+ * samples can also be collected into caller provided arrays (one array
+ * per sample type), which are handed over in chunks of at most
+ * capacity samples. A new sample (row) starts with every
+ * DC_SAMPLE_TIME value. Values that are not present in a sample are
+ * set to NAN (or NAN depth for the deco column). If a sample type is
+ * reported more than once in the same sample, the last value is kept.
+ *
+ * Any of the arrays may be NULL, in which case the corresponding
+ * sample type is not collected. The pressure array is a two
+ * dimensional array with ntanks columns (pressure[i * ntanks + tank]).
+ * Pressures for tanks beyond ntanks are dropped.
+ *
+ * Events are stored in a separate array, and reference their sample by
+ * index. The event names are only guaranteed to remain valid until the
+ * batch callback returns.
+ */
+
+typedef struct dc_sample_deco_t {
+	unsigned int type;
+	unsigned int time;
+	double depth;
+} dc_sample_deco_t;
+
+typedef struct dc_sample_event_t {
+	unsigned int sample; /* Sample index within the batch */
+	unsigned int type;
+	unsigned int time;
+	unsigned int flags;
+	unsigned int value;
+	const char *name;
+} dc_sample_event_t;
+
+typedef struct dc_sample_batch_t {
+	/* Provided by the caller. */
+	unsigned int capacity;
+	unsigned int *time;
+	double *depth;
+	double *temperature;
+	unsigned int ntanks;
+	double *pressure;
+	double *ppo2;
+	dc_sample_deco_t *deco;
+	unsigned int maxevents;
+	dc_sample_event_t *events;
+	/* Filled by the parser. */
+	unsigned int count;
+	unsigned int nevents;
+} dc_sample_batch_t;
+
+typedef void (*dc_sample_batch_callback_t) (const dc_sample_batch_t *batch, void *userdata);
+
+/*
+ * Parallel parsing of many dives
+ *
+ * The work callback is invoked on one of the worker threads, with a
+ * parser that already contains the data of the dive at the given index.
+ * It can extract whatever it needs from the parser and return it as an
+ * opaque result pointer. The parser is owned by the worker, and is
+ * reused for the next dive once the callback returns.
+ *
+ * The consume callback is invoked on the calling thread, strictly in
+ * input order, with the status and result of each dive. Returning zero
+ * cancels the remaining work. Results that were already produced at
+ * that point are still passed to the consume callback (with status
+ * DC_STATUS_CANCELLED, and its return value ignored), such that they
+ * can be released.
+ */
+
+typedef dc_status_t (*dc_parser_batch_work_t) (dc_parser_t *parser, unsigned int index, void **result, void *userdata);
+
+typedef int (*dc_parser_batch_consume_t) (unsigned int index, dc_status_t status, void *result, void *userdata);
+
 dc_status_t
 dc_parser_new (dc_parser_t **parser, dc_device_t *device);
 
@@ -278,18 +399,53 @@ dc_parser_get_type (dc_parser_t *parser);
 dc_status_t
 dc_parser_set_data (dc_parser_t *parser, const unsigned char *data, unsigned int size);
 
+/*
+ * Reset the parser
+ *
+ * Drop the reference to the dive data, and clear all state that was
+ * derived from it. The settings passed at construction time (model,
+ * serial number, clock, calibration) are preserved, so the same parser
+ * can be used again for the next dive with dc_parser_set_data(), which
+ * performs an implicit reset. Resetting a parser never allocates
+ * memory, and releases any memory that was allocated for the previous
+ * dive.
+ */
+dc_status_t
+dc_parser_reset (dc_parser_t *parser);
+
+/*
+ * Set the sample mask
+ *
+ * Only the sample types in the mask (see DC_SAMPLE_MASK) are decoded and
+ * passed to the sample callback. Like the other settings, the mask is
+ * preserved when the parser is reset. The default is DC_SAMPLE_MASK_ALL.
+ */
+dc_status_t
+dc_parser_set_sample_mask (dc_parser_t *parser, unsigned int mask);
+
 dc_status_t
 dc_parser_get_datetime (dc_parser_t *parser, dc_datetime_t *datetime);
 
 dc_status_t
 dc_parser_get_field (dc_parser_t *parser, dc_field_type_t type, unsigned int flags, void *value);
 
+dc_status_t
+dc_parser_get_summary (dc_parser_t *parser, dc_summary_t *summary);
+
 dc_status_t
 dc_parser_samples_foreach (dc_parser_t *parser, dc_sample_callback_t callback, void *userdata);
 
+dc_status_t
+dc_parser_samples_batch (dc_parser_t *parser, dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata);
+
 dc_status_t
 dc_parser_destroy (dc_parser_t *parser);
 
+dc_status_t
+dc_parser_batch (dc_context_t *context, dc_descriptor_t *descriptor, unsigned int devtime, dc_ticks_t systime,
+	const unsigned char *const data[], const unsigned int size[], unsigned int count, unsigned int nthreads,
+	dc_parser_batch_work_t work, dc_parser_batch_consume_t consume, void *userdata);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,78 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_REPLAY_H
+#define DC_REPLAY_H
+
+#include "common.h"
+#include "context.h"
+#include "iostream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+typedef enum dc_replay_flags_t {
+	DC_REPLAY_TIMING = (1 << 0), /* Reproduce the original timing. */
+} dc_replay_flags_t;
+
+/**
+ * Record all data exchanged over an I/O stream.
+ *
+ * The transcript uses the binary trace format, which is documented
+ * with #dc_context_set_tracefile. The recording stream takes ownership
+ * of the underlying I/O stream, and closes it when it is closed.
+ *
+ * @param[out]  iostream   A location to store the recording I/O stream.
+ * @param[in]   context    A valid context object.
+ * @param[in]   base       The I/O stream to record.
+ * @param[in]   filename   The name of the transcript file.
+ * @returns #DC_STATUS_SUCCESS on success, or another #dc_status_t code
+ * on failure.
+ */
+dc_status_t
+dc_record_open (dc_iostream_t **iostream, dc_context_t *context, dc_iostream_t *base, const char *filename);
+
+/**
+ * Replay a recorded transcript.
+ *
+ * The data received from the device is served from the transcript, and
+ * the data sent to the device is compared against the transcript. Any
+ * difference fails with #DC_STATUS_PROTOCOL. Both directions are
+ * matched as independent byte streams, so the size of the individual
+ * packets, and the interleaving of requests and responses, may differ
+ * from the original session. Reading past the end of the transcript
+ * fails with #DC_STATUS_TIMEOUT.
+ *
+ * @param[out]  iostream   A location to store the replaying I/O stream.
+ * @param[in]   context    A valid context object.
+ * @param[in]   filename   The name of the transcript file.
+ * @param[in]   flags      A bitmask of #dc_replay_flags_t values.
+ * @returns #DC_STATUS_SUCCESS on success, or another #dc_status_t code
+ * on failure.
+ */
+dc_status_t
+dc_replay_open (dc_iostream_t **iostream, dc_context_t *context, const char *filename, unsigned int flags);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_REPLAY_H */
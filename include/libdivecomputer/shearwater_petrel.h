@@ -0,0 +1,51 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_SHEARWATER_PETREL_H
+#define DC_SHEARWATER_PETREL_H
+
+#include "common.h"
+#include "device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Set the number of block requests that are kept in flight while
+ * downloading data. A window of one selects the classic stop-and-wait
+ * transfer. The default depends on the transport: pipelining is only
+ * enabled by default for bluetooth low energy. If the device does not
+ * accept a pipelined transfer, the download falls back to stop-and-wait
+ * automatically.
+ *
+ * @param[in]  device  A valid device handle.
+ * @param[in]  window  The number of outstanding requests (1 to 16).
+ * @returns #DC_STATUS_SUCCESS on success, or another #dc_status_t code
+ * on failure.
+ */
+dc_status_t
+shearwater_petrel_device_set_window (dc_device_t *device, unsigned int window);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_SHEARWATER_PETREL_H */
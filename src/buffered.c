@@ -0,0 +1,304 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libdivecomputer/buffered.h>
+
+#include "iostream-private.h"
+#include "context-private.h"
+
+#define DEFAULT_SIZE 4096
+
+static dc_status_t dc_buffered_set_timeout (dc_iostream_t *abstract, int timeout);
+static dc_status_t dc_buffered_set_break (dc_iostream_t *abstract, unsigned int value);
+static dc_status_t dc_buffered_set_dtr (dc_iostream_t *abstract, unsigned int value);
+static dc_status_t dc_buffered_set_rts (dc_iostream_t *abstract, unsigned int value);
+static dc_status_t dc_buffered_get_lines (dc_iostream_t *abstract, unsigned int *value);
+static dc_status_t dc_buffered_get_available (dc_iostream_t *abstract, size_t *value);
+static dc_status_t dc_buffered_configure (dc_iostream_t *abstract, unsigned int baudrate, unsigned int databits, dc_parity_t parity, dc_stopbits_t stopbits, dc_flowcontrol_t flowcontrol);
+static dc_status_t dc_buffered_poll (dc_iostream_t *abstract, int timeout);
+static dc_status_t dc_buffered_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual);
+static dc_status_t dc_buffered_write (dc_iostream_t *abstract, const void *data, size_t size, size_t *actual);
+static dc_status_t dc_buffered_ioctl (dc_iostream_t *abstract, unsigned int request, void *data, size_t size);
+static dc_status_t dc_buffered_flush (dc_iostream_t *abstract);
+static dc_status_t dc_buffered_purge (dc_iostream_t *abstract, dc_direction_t direction);
+static dc_status_t dc_buffered_sleep (dc_iostream_t *abstract, unsigned int milliseconds);
+static dc_status_t dc_buffered_close (dc_iostream_t *abstract);
+
+typedef struct dc_buffered_t {
+	/* Base class. */
+	dc_iostream_t base;
+	/* Internal state. */
+	dc_iostream_t *iostream;
+	unsigned char *buffer;
+	size_t size;
+	size_t offset;
+	size_t length;
+} dc_buffered_t;
+
+static const dc_iostream_vtable_t dc_buffered_vtable = {
+	sizeof(dc_buffered_t),
+	dc_buffered_set_timeout, /* set_timeout */
+	dc_buffered_set_break, /* set_break */
+	dc_buffered_set_dtr, /* set_dtr */
+	dc_buffered_set_rts, /* set_rts */
+	dc_buffered_get_lines, /* get_lines */
+	dc_buffered_get_available, /* get_available */
+	dc_buffered_configure, /* configure */
+	dc_buffered_poll, /* poll */
+	dc_buffered_read, /* read */
+	dc_buffered_write, /* write */
+	dc_buffered_ioctl, /* ioctl */
+	dc_buffered_flush, /* flush */
+	dc_buffered_purge, /* purge */
+	dc_buffered_sleep, /* sleep */
+	dc_buffered_close, /* close */
+};
+
+dc_status_t
+dc_buffered_open (dc_iostream_t **out, dc_context_t *context, dc_iostream_t *base, size_t size)
+{
+	dc_buffered_t *buffered = NULL;
+
+	if (out == NULL || base == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (size == 0)
+		size = DEFAULT_SIZE;
+
+	INFO (context, "Open: size=%u", (unsigned int) size);
+
+	// Allocate memory.
+	buffered = (dc_buffered_t *) dc_iostream_allocate (context, &dc_buffered_vtable, dc_iostream_get_transport (base));
+	if (buffered == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	buffered->buffer = (unsigned char *) malloc (size);
+	if (buffered->buffer == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		dc_iostream_deallocate ((dc_iostream_t *) buffered);
+		return DC_STATUS_NOMEMORY;
+	}
+
+	buffered->iostream = base;
+	buffered->size = size;
+	buffered->offset = 0;
+	buffered->length = 0;
+
+	*out = (dc_iostream_t *) buffered;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_buffered_set_timeout (dc_iostream_t *abstract, int timeout)
+{
+	dc_buffered_t *buffered = (dc_buffered_t *) abstract;
+
+	return dc_iostream_set_timeout (buffered->iostream, timeout);
+}
+
+static dc_status_t
+dc_buffered_set_break (dc_iostream_t *abstract, unsigned int value)
+{
+	dc_buffered_t *buffered = (dc_buffered_t *) abstract;
+
+	return dc_iostream_set_break (buffered->iostream, value);
+}
+
+static dc_status_t
+dc_buffered_set_dtr (dc_iostream_t *abstract, unsigned int value)
+{
+	dc_buffered_t *buffered = (dc_buffered_t *) abstract;
+
+	return dc_iostream_set_dtr (buffered->iostream, value);
+}
+
+static dc_status_t
+dc_buffered_set_rts (dc_iostream_t *abstract, unsigned int value)
+{
+	dc_buffered_t *buffered = (dc_buffered_t *) abstract;
+
+	return dc_iostream_set_rts (buffered->iostream, value);
+}
+
+static dc_status_t
+dc_buffered_get_lines (dc_iostream_t *abstract, unsigned int *value)
+{
+	dc_buffered_t *buffered = (dc_buffered_t *) abstract;
+
+	return dc_iostream_get_lines (buffered->iostream, value);
+}
+
+static dc_status_t
+dc_buffered_get_available (dc_iostream_t *abstract, size_t *value)
+{
+	dc_buffered_t *buffered = (dc_buffered_t *) abstract;
+	size_t available = 0;
+
+	dc_status_t status = dc_iostream_get_available (buffered->iostream, &available);
+
+	*value = buffered->length + available;
+
+	return status;
+}
+
+static dc_status_t
+dc_buffered_configure (dc_iostream_t *abstract, unsigned int baudrate, unsigned int databits, dc_parity_t parity, dc_stopbits_t stopbits, dc_flowcontrol_t flowcontrol)
+{
+	dc_buffered_t *buffered = (dc_buffered_t *) abstract;
+
+	return dc_iostream_configure (buffered->iostream, baudrate, databits, parity, stopbits, flowcontrol);
+}
+
+static dc_status_t
+dc_buffered_poll (dc_iostream_t *abstract, int timeout)
+{
+	dc_buffered_t *buffered = (dc_buffered_t *) abstract;
+
+	if (buffered->length)
+		return DC_STATUS_SUCCESS;
+
+	return dc_iostream_poll (buffered->iostream, timeout);
+}
+
+static dc_status_t
+dc_buffered_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_buffered_t *buffered = (dc_buffered_t *) abstract;
+	unsigned char *p = (unsigned char *) data;
+	size_t nbytes = 0;
+
+	// Serve the buffered data first.
+	if (buffered->length) {
+		nbytes = size < buffered->length ? size : buffered->length;
+		memcpy (p, buffered->buffer + buffered->offset, nbytes);
+		buffered->offset += nbytes;
+		buffered->length -= nbytes;
+	}
+
+	// The rest comes from the underlying stream, to return either all
+	// the requested data or an error, just like an unbuffered read.
+	while (nbytes < size) {
+		size_t remaining = size - nbytes;
+		size_t available = 0;
+		size_t n = 0;
+
+		// Large reads gain nothing from the extra copy. Without any
+		// data available, a larger read would block until the timeout
+		// expires. Pass the read through unchanged in both cases.
+		if (remaining < buffered->size)
+			status = dc_iostream_get_available (buffered->iostream, &available);
+		if (remaining >= buffered->size || status != DC_STATUS_SUCCESS || available <= remaining) {
+			status = dc_iostream_read (buffered->iostream, p + nbytes, remaining, &n);
+			nbytes += n;
+		} else {
+			if (available > buffered->size)
+				available = buffered->size;
+
+			status = dc_iostream_read (buffered->iostream, buffered->buffer, available, &n);
+			buffered->offset = 0;
+			buffered->length = n;
+
+			size_t length = remaining < n ? remaining : n;
+			memcpy (p + nbytes, buffered->buffer, length);
+			buffered->offset += length;
+			buffered->length -= length;
+			nbytes += length;
+
+			if (length == remaining)
+				status = DC_STATUS_SUCCESS;
+		}
+
+		if (status != DC_STATUS_SUCCESS)
+			break;
+
+		// Don't loop forever on a stream without any progress.
+		if (n == 0) {
+			status = DC_STATUS_TIMEOUT;
+			break;
+		}
+	}
+
+	*actual = nbytes;
+
+	return status;
+}
+
+static dc_status_t
+dc_buffered_write (dc_iostream_t *abstract, const void *data, size_t size, size_t *actual)
+{
+	dc_buffered_t *buffered = (dc_buffered_t *) abstract;
+
+	return dc_iostream_write (buffered->iostream, data, size, actual);
+}
+
+static dc_status_t
+dc_buffered_ioctl (dc_iostream_t *abstract, unsigned int request, void *data, size_t size)
+{
+	dc_buffered_t *buffered = (dc_buffered_t *) abstract;
+
+	return dc_iostream_ioctl (buffered->iostream, request, data, size);
+}
+
+static dc_status_t
+dc_buffered_flush (dc_iostream_t *abstract)
+{
+	dc_buffered_t *buffered = (dc_buffered_t *) abstract;
+
+	return dc_iostream_flush (buffered->iostream);
+}
+
+static dc_status_t
+dc_buffered_purge (dc_iostream_t *abstract, dc_direction_t direction)
+{
+	dc_buffered_t *buffered = (dc_buffered_t *) abstract;
+
+	if (direction & DC_DIRECTION_INPUT) {
+		buffered->offset = 0;
+		buffered->length = 0;
+	}
+
+	return dc_iostream_purge (buffered->iostream, direction);
+}
+
+static dc_status_t
+dc_buffered_sleep (dc_iostream_t *abstract, unsigned int milliseconds)
+{
+	dc_buffered_t *buffered = (dc_buffered_t *) abstract;
+
+	return dc_iostream_sleep (buffered->iostream, milliseconds);
+}
+
+static dc_status_t
+dc_buffered_close (dc_iostream_t *abstract)
+{
+	dc_buffered_t *buffered = (dc_buffered_t *) abstract;
+
+	free (buffered->buffer);
+
+	return dc_iostream_close (buffered->iostream);
+}
@@ -110,9 +110,12 @@ static const dc_parser_vtable_t cochran_commander_parser_vtable = {
 	sizeof(cochran_commander_parser_t),
 	DC_FAMILY_COCHRAN_COMMANDER,
 	cochran_commander_parser_set_data, /* set_data */
+	NULL, /* reset */
 	cochran_commander_parser_get_datetime, /* datetime */
 	cochran_commander_parser_get_field, /* fields */
+	NULL, /* summary */
 	cochran_commander_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -216,39 +219,40 @@ static const cochran_parser_layout_t cochran_emc_parser_layout = {
 	407,         // max_temp, 1 byte, /2+20=F
 };
 
-static const cochran_events_t cochran_events[] = {
-	{0xA8, 1, SAMPLE_EVENT_SURFACE,  SAMPLE_FLAGS_BEGIN}, // Entered PDI mode
-	{0xA9, 1, SAMPLE_EVENT_SURFACE,  SAMPLE_FLAGS_END},   // Exited PDI mode
-	{0xAB, 5, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Ceiling decrease
-	{0xAD, 5, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Ceiling increase
-	{0xB5, 1, SAMPLE_EVENT_AIRTIME,  SAMPLE_FLAGS_BEGIN}, // Air < 5 mins deco
-	{0xBD, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Switched to nomal PO2 setting
-	{0xBE, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Ceiling > 60 ft
-	{0xC0, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Switched to FO2 21% mode
-	{0xC1, 1, SAMPLE_EVENT_ASCENT,   SAMPLE_FLAGS_BEGIN}, // Ascent rate greater than limit
-	{0xC2, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Low battery warning
-	{0xC3, 1, SAMPLE_EVENT_OLF,      SAMPLE_FLAGS_NONE},  // CNS Oxygen toxicity warning
-	{0xC4, 1, SAMPLE_EVENT_MAXDEPTH, SAMPLE_FLAGS_NONE},  // Depth exceeds user set point
-	{0xC5, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_BEGIN}, // Entered decompression mode
-	{0xC7, 1, SAMPLE_EVENT_VIOLATION,SAMPLE_FLAGS_BEGIN}, // Entered Gauge mode (e.g. locked out)
-	{0xC8, 1, SAMPLE_EVENT_PO2,      SAMPLE_FLAGS_BEGIN}, // PO2 too high
-	{0xCC, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_BEGIN}, // Low Cylinder 1 pressure
-	{0xCE, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_BEGIN}, // Non-decompression warning
-	{0xCF, 1, SAMPLE_EVENT_OLF,      SAMPLE_FLAGS_BEGIN}, // O2 Toxicity
-	{0xCD, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Switched to deco blend
-	{0xD0, 1, SAMPLE_EVENT_WORKLOAD, SAMPLE_FLAGS_BEGIN}, // Breathing rate alarm
-	{0xD3, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Low gas 1 flow rate
-	{0xD6, 1, SAMPLE_EVENT_CEILING,  SAMPLE_FLAGS_BEGIN}, // Depth is less than ceiling
-	{0xD8, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_END},   // End decompression mode
-	{0xE1, 1, SAMPLE_EVENT_ASCENT,   SAMPLE_FLAGS_END},   // End ascent rate warning
-	{0xE2, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Low SBAT battery warning
-	{0xE3, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Switched to FO2 mode
-	{0xE5, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Switched to PO2 mode
-	{0xEE, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_END},   // End non-decompresison warning
-	{0xEF, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Switch to blend 2
-	{0xF0, 1, SAMPLE_EVENT_WORKLOAD, SAMPLE_FLAGS_END},   // Breathing rate alarm
-	{0xF3, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Switch to blend 1
-	{0xF6, 1, SAMPLE_EVENT_CEILING,  SAMPLE_FLAGS_END},   // End Depth is less than ceiling
+// Indexed by event code. Unknown codes have no data bytes.
+static const cochran_events_t cochran_events[256] = {
+	[0xA8] = {0xA8, 1, SAMPLE_EVENT_SURFACE,  SAMPLE_FLAGS_BEGIN}, // Entered PDI mode
+	[0xA9] = {0xA9, 1, SAMPLE_EVENT_SURFACE,  SAMPLE_FLAGS_END},   // Exited PDI mode
+	[0xAB] = {0xAB, 5, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Ceiling decrease
+	[0xAD] = {0xAD, 5, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Ceiling increase
+	[0xB5] = {0xB5, 1, SAMPLE_EVENT_AIRTIME,  SAMPLE_FLAGS_BEGIN}, // Air < 5 mins deco
+	[0xBD] = {0xBD, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Switched to nomal PO2 setting
+	[0xBE] = {0xBE, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Ceiling > 60 ft
+	[0xC0] = {0xC0, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Switched to FO2 21% mode
+	[0xC1] = {0xC1, 1, SAMPLE_EVENT_ASCENT,   SAMPLE_FLAGS_BEGIN}, // Ascent rate greater than limit
+	[0xC2] = {0xC2, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Low battery warning
+	[0xC3] = {0xC3, 1, SAMPLE_EVENT_OLF,      SAMPLE_FLAGS_NONE},  // CNS Oxygen toxicity warning
+	[0xC4] = {0xC4, 1, SAMPLE_EVENT_MAXDEPTH, SAMPLE_FLAGS_NONE},  // Depth exceeds user set point
+	[0xC5] = {0xC5, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_BEGIN}, // Entered decompression mode
+	[0xC7] = {0xC7, 1, SAMPLE_EVENT_VIOLATION,SAMPLE_FLAGS_BEGIN}, // Entered Gauge mode (e.g. locked out)
+	[0xC8] = {0xC8, 1, SAMPLE_EVENT_PO2,      SAMPLE_FLAGS_BEGIN}, // PO2 too high
+	[0xCC] = {0xCC, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_BEGIN}, // Low Cylinder 1 pressure
+	[0xCE] = {0xCE, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_BEGIN}, // Non-decompression warning
+	[0xCF] = {0xCF, 1, SAMPLE_EVENT_OLF,      SAMPLE_FLAGS_BEGIN}, // O2 Toxicity
+	[0xCD] = {0xCD, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Switched to deco blend
+	[0xD0] = {0xD0, 1, SAMPLE_EVENT_WORKLOAD, SAMPLE_FLAGS_BEGIN}, // Breathing rate alarm
+	[0xD3] = {0xD3, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Low gas 1 flow rate
+	[0xD6] = {0xD6, 1, SAMPLE_EVENT_CEILING,  SAMPLE_FLAGS_BEGIN}, // Depth is less than ceiling
+	[0xD8] = {0xD8, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_END},   // End decompression mode
+	[0xE1] = {0xE1, 1, SAMPLE_EVENT_ASCENT,   SAMPLE_FLAGS_END},   // End ascent rate warning
+	[0xE2] = {0xE2, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Low SBAT battery warning
+	[0xE3] = {0xE3, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Switched to FO2 mode
+	[0xE5] = {0xE5, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Switched to PO2 mode
+	[0xEE] = {0xEE, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_END},   // End non-decompresison warning
+	[0xEF] = {0xEF, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Switch to blend 2
+	[0xF0] = {0xF0, 1, SAMPLE_EVENT_WORKLOAD, SAMPLE_FLAGS_END},   // Breathing rate alarm
+	[0xF3] = {0xF3, 1, SAMPLE_EVENT_NONE,     SAMPLE_FLAGS_NONE},  // Switch to blend 1
+	[0xF6] = {0xF6, 1, SAMPLE_EVENT_CEILING,  SAMPLE_FLAGS_END},   // End Depth is less than ceiling
 };
 
 static const event_size_t cochran_cmdr_event_bytes[] = {
@@ -272,15 +276,8 @@ cochran_commander_handle_event (cochran_commander_parser_t *parser, unsigned cha
 {
 	dc_parser_t *abstract = (dc_parser_t *) parser;
 
-	const cochran_events_t *event = NULL;
-	for (unsigned int i = 0; i < C_ARRAY_SIZE(cochran_events); ++i) {
-		if (cochran_events[i].code == code) {
-			event = cochran_events + i;
-			break;
-		}
-	}
-
-	if (event == NULL) {
+	const cochran_events_t *event = cochran_events + code;
+	if (event->data_bytes == 0) {
 		// Unknown event, send warning so we know we missed something
 		WARNING(abstract->context, "Unknown event 0x%02x", code);
 		return 1;
@@ -325,24 +322,31 @@ cochran_commander_handle_event (cochran_commander_parser_t *parser, unsigned cha
 /*
  * Used to find the end of a dive that has an incomplete dive-end
  * block. It parses backwards past inter-dive events.
+ *
+ * Because we are parsing backwards and the events vary in size, we can't be
+ * sure a byte that matches an event code is an event code or data from
+ * inside a longer or shorter event. Therefore all possible chains of events
+ * are followed, and the position furthest back is returned. Every position
+ * is visited only once, and since the events are smaller than 32 bytes,
+ * only the reachable positions within a 32 byte window need to be tracked.
  */
 static int
 cochran_commander_backparse(cochran_commander_parser_t *parser, const unsigned char *samples, int size)
 {
-	int result = size, best_result = size;
-
-	for (unsigned int i = 0; i < parser->nevents; i++) {
-		int ptr = size - parser->events[i].size;
-		if (ptr > 0 && samples[ptr] == parser->events[i].code) {
-			// Recurse to find the largest match. Because we are parsing backwards
-			// and the events vary in size we can't be sure the byte that matches
-			// the event code is an event code or data from inside a longer or shorter
-			// event.
-			result = cochran_commander_backparse(parser, samples, ptr);
-		}
+	unsigned int reachable = 1; // Bit n set: position (ptr - n) is reachable.
+	int best_result = size;
+
+	for (int ptr = size; ptr > 0 && reachable; ptr--, reachable >>= 1) {
+		if ((reachable & 1) == 0)
+			continue;
 
-		if (result < best_result) {
-			best_result = result;
+		best_result = ptr;
+
+		for (unsigned int i = 0; i < parser->nevents; i++) {
+			unsigned int n = parser->events[i].size;
+			if (ptr - (int) n > 0 && samples[ptr - n] == parser->events[i].code) {
+				reachable |= 1u << n;
+			}
 		}
 	}
 
@@ -26,6 +26,8 @@
 #include "config.h"
 #endif
 
+#include <stddef.h>
+
 #include <libdivecomputer/context.h>
 
 #ifdef __cplusplus
@@ -53,6 +55,7 @@ extern "C" {
 #define WARNING(context, ...) dc_context_log (context, DC_LOGLEVEL_WARNING, __FILE__, __LINE__, FUNCTION, __VA_ARGS__)
 #define INFO(context, ...) dc_context_log (context, DC_LOGLEVEL_INFO, __FILE__, __LINE__, FUNCTION, __VA_ARGS__)
 #define DEBUG(context, ...) dc_context_log (context, DC_LOGLEVEL_DEBUG, __FILE__, __LINE__, FUNCTION, __VA_ARGS__)
+#define TRACE(context, type, transport, request, status, data, size) dc_context_trace (context, type, transport, request, status, data, size)
 #else
 #define HEXDUMP(context, loglevel, prefix, data, size) UNUSED(context)
 #define SYSERROR(context, errcode) UNUSED(context)
@@ -60,6 +63,7 @@ extern "C" {
 #define WARNING(context, ...) UNUSED(context)
 #define INFO(context, ...) UNUSED(context)
 #define DEBUG(context, ...) UNUSED(context)
+#define TRACE(context, type, transport, request, status, data, size) UNUSED(context)
 #endif
 
 dc_status_t
@@ -71,6 +75,9 @@ dc_context_syserror (dc_context_t *context, dc_loglevel_t loglevel, const char *
 dc_status_t
 dc_context_hexdump (dc_context_t *context, dc_loglevel_t loglevel, const char *file, unsigned int line, const char *function, const char *prefix, const unsigned char data[], unsigned int size);
 
+dc_status_t
+dc_context_trace (dc_context_t *context, dc_trace_t type, dc_transport_t transport, unsigned int request, dc_status_t status, const unsigned char data[], size_t size);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -37,14 +37,63 @@
 
 #include "context-private.h"
 #include "timer.h"
+#include "thread.h"
+#include "trace.h"
+
+#define MSGSIZE (16384 + 32)
+
+#ifdef ENABLE_LOGGING
+/*
+ * A record in the log queue. The formatted message is followed by the
+ * raw bytes of a hexdump, which are only converted to hex characters on
+ * the background thread.
+ */
+typedef struct dc_logrecord_t {
+	dc_atomic_t sequence;
+	dc_loglevel_t loglevel;
+	const char *file;
+	unsigned int line;
+	const char *function;
+	dc_usecs_t timestamp;
+	size_t length;
+	size_t size;
+	size_t capacity;
+	char *data;
+} dc_logrecord_t;
+
+/*
+ * A bounded multi-producer single-consumer queue, based on the per-slot
+ * sequence numbers of Dmitry Vyukov's design. Producers never block.
+ * When the queue is full, the message is dropped and counted instead.
+ * The mutex and condition variable are only used to wake up the
+ * background thread when it ran out of work.
+ */
+typedef struct dc_logqueue_t {
+	dc_context_t *context;
+	dc_logrecord_t *records;
+	unsigned long mask;
+	dc_atomic_t head;
+	unsigned long tail;
+	dc_atomic_t dropped;
+	dc_atomic_t sleeping;
+	dc_atomic_t quit;
+	dc_mutex_t *mutex;
+	dc_cond_t *cond;
+	dc_thread_t *thread;
+	dc_usecs_t timestamp;
+	char msg[MSGSIZE];
+} dc_logqueue_t;
+#endif
 
 struct dc_context_t {
 	dc_loglevel_t loglevel;
 	dc_logfunc_t logfunc;
 	void *userdata;
 #ifdef ENABLE_LOGGING
-	char msg[16384 + 32];
+	dc_logqueue_t *logqueue;
 	dc_timer_t *timer;
+	FILE *tracefile;
+	dc_mutex_t *tracelock;
 #endif
 };
 
@@ -136,7 +185,12 @@ loghandler (dc_context_t *context, dc_loglevel_t loglevel, const char *file, uns
 	const char *loglevels[] = {"NONE", "ERROR", "WARNING", "INFO", "DEBUG", "ALL"};
 
 	dc_usecs_t now = 0;
-	dc_timer_now (context->timer, &now);
+	if (context->logqueue) {
+		/* Use the time at which the message was queued. */
+		now = context->logqueue->timestamp;
+	} else {
+		dc_timer_now (context->timer, &now);
+	}
 
 	unsigned long seconds = now / 1000000;
 	unsigned long microseconds = now % 1000000;
@@ -151,6 +205,155 @@ loghandler (dc_context_t *context, dc_loglevel_t loglevel, const char *file, uns
 			loglevels[loglevel], msg);
 	}
 }
+
+static void
+logqueue_push (dc_logqueue_t *queue, dc_loglevel_t loglevel, const char *file, unsigned int line, const char *function, const char *msg, size_t length, const unsigned char data[], size_t size)
+{
+	dc_logrecord_t *record = NULL;
+	unsigned long pos = dc_atomic_load (&queue->head);
+
+	for (;;) {
+		record = queue->records + (pos & queue->mask);
+		unsigned long sequence = dc_atomic_load (&record->sequence);
+		long diff = (long) (sequence - pos);
+		if (diff == 0) {
+			if (dc_atomic_cas (&queue->head, (long) pos, (long) (pos + 1)))
+				break;
+			pos = dc_atomic_load (&queue->head);
+		} else if (diff < 0) {
+			/* The queue is full. */
+			dc_atomic_add (&queue->dropped, 1);
+			return;
+		} else {
+			pos = dc_atomic_load (&queue->head);
+		}
+	}
+
+	if (record->capacity < length + size) {
+		char *buffer = (char *) realloc (record->data, length + size);
+		if (buffer == NULL) {
+			dc_atomic_add (&queue->dropped, 1);
+			loglevel = DC_LOGLEVEL_NONE;
+			length = size = 0;
+		} else {
+			record->data = buffer;
+			record->capacity = length + size;
+		}
+	}
+
+	record->loglevel = loglevel;
+	record->file = file;
+	record->line = line;
+	record->function = function;
+	record->length = length;
+	record->size = size;
+	if (length)
+		memcpy (record->data, msg, length);
+	if (size)
+		memcpy (record->data + length, data, size);
+
+	record->timestamp = 0;
+	dc_timer_now (queue->context->timer, &record->timestamp);
+
+	/* Publish the record. */
+	dc_atomic_store (&record->sequence, (long) (pos + 1));
+
+	if (dc_atomic_load (&queue->sleeping)) {
+		dc_mutex_lock (queue->mutex);
+		dc_cond_signal (queue->cond);
+		dc_mutex_unlock (queue->mutex);
+	}
+}
+
+static int
+logqueue_ready (dc_logqueue_t *queue)
+{
+	dc_logrecord_t *record = queue->records + (queue->tail & queue->mask);
+	return (unsigned long) dc_atomic_load (&record->sequence) == queue->tail + 1;
+}
+
+static int
+logqueue_pop (dc_logqueue_t *queue)
+{
+	dc_context_t *context = queue->context;
+	dc_logrecord_t *record = queue->records + (queue->tail & queue->mask);
+
+	if (!logqueue_ready (queue))
+		return 0;
+
+	if (record->loglevel != DC_LOGLEVEL_NONE && context->logfunc) {
+		memcpy (queue->msg, record->data, record->length);
+		queue->msg[record->length] = 0;
+		if (record->size) {
+			l_hexdump (queue->msg + record->length, sizeof (queue->msg) - record->length,
+				(const unsigned char *) record->data + record->length, record->size);
+		}
+
+		queue->timestamp = record->timestamp;
+		context->logfunc (context, record->loglevel, record->file, record->line, record->function, queue->msg, context->userdata);
+	}
+
+	/* Release the slot to the producers. */
+	dc_atomic_store (&record->sequence, (long) (queue->tail + queue->mask + 1));
+	queue->tail++;
+
+	return 1;
+}
+
+static void
+logqueue_run (void *userdata)
+{
+	dc_logqueue_t *queue = (dc_logqueue_t *) userdata;
+	dc_context_t *context = queue->context;
+
+	for (;;) {
+		long dropped = dc_atomic_exchange (&queue->dropped, 0);
+		if (dropped && context->logfunc) {
+			l_snprintf (queue->msg, sizeof (queue->msg), "%li log messages dropped.", dropped);
+			dc_timer_now (context->timer, &queue->timestamp);
+			context->logfunc (context, DC_LOGLEVEL_WARNING, __FILE__, __LINE__, __func__, queue->msg, context->userdata);
+		}
+
+		if (logqueue_pop (queue))
+			continue;
+
+		if (dc_atomic_load (&queue->quit))
+			break;
+
+		dc_mutex_lock (queue->mutex);
+		dc_atomic_store (&queue->sleeping, 1);
+		if (!logqueue_ready (queue) && !dc_atomic_load (&queue->quit))
+			dc_cond_wait (queue->cond, queue->mutex);
+		dc_atomic_store (&queue->sleeping, 0);
+		dc_mutex_unlock (queue->mutex);
+	}
+}
+
+static void
+logqueue_free (dc_logqueue_t *queue)
+{
+	if (queue == NULL)
+		return;
+
+	if (queue->thread) {
+		dc_mutex_lock (queue->mutex);
+		dc_atomic_store (&queue->quit, 1);
+		dc_cond_signal (queue->cond);
+		dc_mutex_unlock (queue->mutex);
+		dc_thread_join (queue->thread);
+	}
+
+	if (queue->records) {
+		for (unsigned long i = 0; i <= queue->mask; ++i) {
+			free (queue->records[i].data);
+		}
+	}
+
+	dc_cond_free (queue->cond);
+	dc_mutex_free (queue->mutex);
+	free (queue->records);
+	free (queue);
+}
 #endif
 
 dc_status_t
@@ -175,8 +378,10 @@ dc_context_new (dc_context_t **out)
 	context->userdata = NULL;
 
 #ifdef ENABLE_LOGGING
-	memset (context->msg, 0, sizeof (context->msg));
+	context->logqueue = NULL;
 	context->timer = NULL;
+	context->tracefile = NULL;
+	context->tracelock = NULL;
 	dc_timer_new (&context->timer);
 #endif
 
@@ -192,6 +397,9 @@ dc_context_free (dc_context_t *context)
 		return DC_STATUS_SUCCESS;
 
 #ifdef ENABLE_LOGGING
+	logqueue_free (context->logqueue);
+	dc_context_set_tracefile (context, NULL);
+	dc_mutex_free (context->tracelock);
 	dc_timer_free (context->timer);
 #endif
 	free (context);
@@ -226,10 +434,76 @@ dc_context_set_logfunc (dc_context_t *context, dc_logfunc_t logfunc, void *userd
 	return DC_STATUS_SUCCESS;
 }
 
+dc_status_t
+dc_context_set_logqueue (dc_context_t *context, unsigned int capacity)
+{
+#ifdef ENABLE_LOGGING
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_logqueue_t *queue = NULL;
+	unsigned long size = 2;
+#endif
+
+	if (context == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+#ifdef ENABLE_LOGGING
+	/* Flush and stop the current queue. */
+	logqueue_free (context->logqueue);
+	context->logqueue = NULL;
+
+	if (capacity == 0)
+		return DC_STATUS_SUCCESS;
+
+	/* Round up to the next power of two. */
+	while (size < capacity && size <= LONG_MAX / 2)
+		size *= 2;
+
+	queue = (dc_logqueue_t *) calloc (1, sizeof (dc_logqueue_t));
+	if (queue == NULL)
+		return DC_STATUS_NOMEMORY;
+
+	queue->context = context;
+	queue->mask = size - 1;
+	queue->records = (dc_logrecord_t *) calloc (size, sizeof (dc_logrecord_t));
+	if (queue->records == NULL) {
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	for (unsigned long i = 0; i < size; ++i) {
+		dc_atomic_store (&queue->records[i].sequence, (long) i);
+	}
+
+	status = dc_mutex_new (&queue->mutex);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	status = dc_cond_new (&queue->cond);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	status = dc_thread_new (&queue->thread, logqueue_run, queue);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	context->logqueue = queue;
+
+	return DC_STATUS_SUCCESS;
+
+error_free:
+	logqueue_free (queue);
+	return status;
+#else
+	UNUSED(capacity);
+	return DC_STATUS_SUCCESS;
+#endif
+}
+
 dc_status_t
 dc_context_log (dc_context_t *context, dc_loglevel_t loglevel, const char *file, unsigned int line, const char *function, const char *format, ...)
 {
 #ifdef ENABLE_LOGGING
+	char msg[MSGSIZE];
 	va_list ap;
 #endif
 
@@ -244,10 +518,14 @@ dc_context_log (dc_context_t *context, dc_loglevel_t loglevel, const char *file,
 		return DC_STATUS_SUCCESS;
 
 	va_start (ap, format);
-	l_vsnprintf (context->msg, sizeof (context->msg), format, ap);
+	l_vsnprintf (msg, sizeof (msg), format, ap);
 	va_end (ap);
 
-	context->logfunc (context, loglevel, file, line, function, context->msg, context->userdata);
+	if (context->logqueue) {
+		logqueue_push (context->logqueue, loglevel, file, line, function, msg, strlen (msg), NULL, 0);
+	} else {
+		context->logfunc (context, loglevel, file, line, function, msg, context->userdata);
+	}
 #endif
 
 	return DC_STATUS_SUCCESS;
@@ -297,6 +575,7 @@ dc_status_t
 dc_context_hexdump (dc_context_t *context, dc_loglevel_t loglevel, const char *file, unsigned int line, const char *function, const char *prefix, const unsigned char data[], unsigned int size)
 {
 #ifdef ENABLE_LOGGING
+	char msg[MSGSIZE];
 	int n;
 #endif
 
@@ -310,13 +589,115 @@ dc_context_hexdump (dc_context_t *context, dc_loglevel_t loglevel, const char *f
 	if (context->logfunc == NULL)
 		return DC_STATUS_SUCCESS;
 
-	n = l_snprintf (context->msg, sizeof (context->msg), "%s: size=%u, data=", prefix, size);
+	n = l_snprintf (msg, sizeof (msg), "%s: size=%u, data=", prefix, size);
+
+	if (context->logqueue) {
+		/* Leave the conversion to hex characters to the background thread. */
+		size_t length = (n >= 0 ? (size_t) n : strlen (msg));
+		size_t maxsize = (n >= 0 ? (sizeof (msg) - n - 1) / 2 : 0);
+		logqueue_push (context->logqueue, loglevel, file, line, function, msg, length,
+			data, size > maxsize ? maxsize : size);
+		return DC_STATUS_SUCCESS;
+	}
 
 	if (n >= 0) {
-		n = l_hexdump (context->msg + n, sizeof (context->msg) - n, data, size);
+		n = l_hexdump (msg + n, sizeof (msg) - n, data, size);
+	}
+
+	context->logfunc (context, loglevel, file, line, function, msg, context->userdata);
+#endif
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_context_set_tracefile (dc_context_t *context, const char *filename)
+{
+#ifdef ENABLE_LOGGING
+	dc_status_t status = DC_STATUS_SUCCESS;
+	FILE *fp = NULL;
+#endif
+
+	if (context == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+#ifdef ENABLE_LOGGING
+	// Without the lock, there is no trace file yet.
+	if (context->tracelock) {
+		dc_mutex_lock (context->tracelock);
+		fp = context->tracefile;
+		context->tracefile = NULL;
+		dc_mutex_unlock (context->tracelock);
+
+		if (fp)
+			fclose (fp);
 	}
 
-	context->logfunc (context, loglevel, file, line, function, context->msg, context->userdata);
+	if (filename == NULL)
+		return DC_STATUS_SUCCESS;
+
+	// The lock has to exist before the trace file is published.
+	if (context->tracelock == NULL) {
+		status = dc_mutex_new (&context->tracelock);
+		if (status != DC_STATUS_SUCCESS)
+			return status;
+	}
+
+	fp = fopen (filename, "wb");
+	if (fp == NULL) {
+		ERROR (context, "Failed to open the trace file.");
+		return DC_STATUS_IO;
+	}
+
+	status = dc_trace_write_header (fp);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (context, "Failed to write the trace file.");
+		fclose (fp);
+		return status;
+	}
+
+	dc_mutex_lock (context->tracelock);
+	context->tracefile = fp;
+	dc_mutex_unlock (context->tracelock);
+
+	return DC_STATUS_SUCCESS;
+#else
+	UNUSED(filename);
+	return DC_STATUS_UNSUPPORTED;
+#endif
+}
+
+dc_status_t
+dc_context_trace (dc_context_t *context, dc_trace_t type, dc_transport_t transport, unsigned int request, dc_status_t status, const unsigned char data[], size_t size)
+{
+#ifdef ENABLE_LOGGING
+	dc_trace_record_t record;
+#endif
+
+	if (context == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+#ifdef ENABLE_LOGGING
+	// The lock is created before the first trace file.
+	if (context->tracelock == NULL)
+		return DC_STATUS_SUCCESS;
+
+	if (size > 0xFFFFFFFF)
+		size = 0xFFFFFFFF;
+
+	record.timestamp = 0;
+	record.type = type;
+	record.transport = transport;
+	record.request = request;
+	record.status = status;
+	record.data = data;
+	record.size = size;
+	dc_timer_now (context->timer, &record.timestamp);
+
+	dc_mutex_lock (context->tracelock);
+	if (context->tracefile)
+		dc_trace_write_record (context->tracefile, &record);
+	dc_mutex_unlock (context->tracelock);
 #endif
 
 	return DC_STATUS_SUCCESS;
@@ -56,17 +56,22 @@ struct cressi_goa_parser_t {
 };
 
 static dc_status_t cressi_goa_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t cressi_goa_parser_reset (dc_parser_t *abstract);
 static dc_status_t cressi_goa_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t cressi_goa_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t cressi_goa_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t cressi_goa_parser_samples (cressi_goa_parser_t *parser, unsigned int mask, dc_sample_callback_t callback, void *userdata);
 
 static const dc_parser_vtable_t cressi_goa_parser_vtable = {
 	sizeof(cressi_goa_parser_t),
 	DC_FAMILY_CRESSI_GOA,
 	cressi_goa_parser_set_data, /* set_data */
+	cressi_goa_parser_reset, /* reset */
 	cressi_goa_parser_get_datetime, /* datetime */
 	cressi_goa_parser_get_field, /* fields */
+	NULL, /* summary */
 	cressi_goa_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -102,7 +107,7 @@ cressi_goa_parser_create (dc_parser_t **out, dc_context_t *context, unsigned int
 }
 
 static dc_status_t
-cressi_goa_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+cressi_goa_parser_reset (dc_parser_t *abstract)
 {
 	cressi_goa_parser_t *parser = (cressi_goa_parser_t *) abstract;
 
@@ -113,6 +118,12 @@ cressi_goa_parser_set_data (dc_parser_t *abstract, const unsigned char *data, un
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+cressi_goa_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
 static dc_status_t
 cressi_goa_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
 {
@@ -166,14 +177,9 @@ cressi_goa_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsign
 		return DC_STATUS_DATAFORMAT;
 
 	if (!parser->cached) {
-		sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
-		dc_status_t rc = cressi_goa_parser_samples_foreach (
-			abstract, sample_statistics_cb, &statistics);
+		dc_status_t rc = cressi_goa_parser_samples (parser, DC_SAMPLE_MASK_STATISTICS, NULL, NULL);
 		if (rc != DC_STATUS_SUCCESS)
 			return rc;
-
-		parser->cached = 1;
-		parser->maxdepth = statistics.maxdepth;
 	}
 
 	dc_gasmix_t *gasmix = (dc_gasmix_t *) value;
@@ -218,11 +224,18 @@ cressi_goa_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsign
 	return DC_STATUS_SUCCESS;
 }
 
+/*
+ * Walk the profile data. The maximum depth is collected on the fly, so the
+ * profile statistics come for free with the first walk. Sample types that
+ * are not in the mask are not decoded.
+ */
 static dc_status_t
-cressi_goa_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
+cressi_goa_parser_samples (cressi_goa_parser_t *parser, unsigned int mask, dc_sample_callback_t callback, void *userdata)
 {
+	dc_parser_t *abstract = (dc_parser_t *) parser;
 	const unsigned char *data = abstract->data;
 	unsigned int size = abstract->size;
+	double maxdepth = 0.0;
 
 	if (size < SZ_HEADER)
 		return DC_STATUS_DATAFORMAT;
@@ -272,7 +285,7 @@ cressi_goa_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t c
 			if (callback) callback (DC_SAMPLE_TIME, sample, userdata);
 
 			// Temperature (1/10 °C).
-			if (have_temperature) {
+			if (have_temperature && DC_SAMPLE_WANTED(mask, DC_SAMPLE_TEMPERATURE)) {
 				sample.temperature = temperature / 10.0;
 				if (callback) callback (DC_SAMPLE_TEMPERATURE, sample, userdata);
 				have_temperature = 0;
@@ -280,10 +293,12 @@ cressi_goa_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t c
 
 			// Depth (1/10 m).
 			sample.depth = depth / 10.0;
+			if (maxdepth < sample.depth)
+				maxdepth = sample.depth;
 			if (callback) callback (DC_SAMPLE_DEPTH, sample, userdata);
 
 			// Gas change
-			if (divemode == SCUBA || divemode == NITROX) {
+			if ((divemode == SCUBA || divemode == NITROX) && DC_SAMPLE_WANTED(mask, DC_SAMPLE_GASMIX)) {
 				if (gasmix != gasmix_previous) {
 					sample.gasmix = gasmix;
 					if (callback) callback (DC_SAMPLE_GASMIX, sample, userdata);
@@ -297,5 +312,18 @@ cressi_goa_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t c
 		offset += 2;
 	}
 
+	// Cache the profile statistics.
+	parser->cached = 1;
+	parser->maxdepth = maxdepth;
+
 	return DC_STATUS_SUCCESS;
 }
+
+
+static dc_status_t
+cressi_goa_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
+{
+	cressi_goa_parser_t *parser = (cressi_goa_parser_t *) abstract;
+
+	return cressi_goa_parser_samples (parser, abstract->samplemask, callback, userdata);
+}
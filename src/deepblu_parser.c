@@ -50,6 +50,7 @@ typedef struct deepblu_parser_t {
 } deepblu_parser_t;
 
 static dc_status_t deepblu_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t deepblu_parser_reset (dc_parser_t *abstract);
 static dc_status_t deepblu_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t deepblu_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t deepblu_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -58,9 +59,12 @@ static const dc_parser_vtable_t deepblu_parser_vtable = {
 	sizeof(deepblu_parser_t),
 	DC_FAMILY_DEEPBLU,
 	deepblu_parser_set_data, /* set_data */
+	deepblu_parser_reset, /* reset */
 	deepblu_parser_get_datetime, /* datetime */
 	deepblu_parser_get_field, /* fields */
+	NULL, /* summary */
 	deepblu_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -79,6 +83,8 @@ deepblu_parser_create (dc_parser_t **out, dc_context_t *context)
 		return DC_STATUS_NOMEMORY;
 	}
 
+	deepblu_parser_reset ((dc_parser_t *) parser);
+
 	*out = (dc_parser_t *) parser;
 
 	return DC_STATUS_SUCCESS;
@@ -97,6 +103,18 @@ pressure_to_depth(unsigned int mbar)
 	return mbar / specific_weight / 100.0;
 }
 
+static dc_status_t
+deepblu_parser_reset (dc_parser_t *abstract)
+{
+	deepblu_parser_t *deepblu = (deepblu_parser_t *) abstract;
+
+	deepblu->callback = NULL;
+	deepblu->userdata = NULL;
+	memset(&deepblu->cache, 0, sizeof(deepblu->cache));
+
+	return DC_STATUS_SUCCESS;
+}
+
 static dc_status_t
 deepblu_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
 {
@@ -109,10 +127,6 @@ deepblu_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsig
 	if (size < 256)
 		return DC_STATUS_IO;
 
-	deepblu->callback = NULL;
-	deepblu->userdata = NULL;
-	memset(&deepblu->cache, 0, sizeof(deepblu->cache));
-
 	// LE16 at 0 is 'dive number'
 
 	// LE16 at 12 is the dive time
@@ -50,6 +50,7 @@ struct diverite_nitekq_parser_t {
 };
 
 static dc_status_t diverite_nitekq_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t diverite_nitekq_parser_reset (dc_parser_t *abstract);
 static dc_status_t diverite_nitekq_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t diverite_nitekq_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t diverite_nitekq_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -58,9 +59,12 @@ static const dc_parser_vtable_t diverite_nitekq_parser_vtable = {
 	sizeof(diverite_nitekq_parser_t),
 	DC_FAMILY_DIVERITE_NITEKQ,
 	diverite_nitekq_parser_set_data, /* set_data */
+	diverite_nitekq_parser_reset, /* reset */
 	diverite_nitekq_parser_get_datetime, /* datetime */
 	diverite_nitekq_parser_get_field, /* fields */
+	NULL, /* summary */
 	diverite_nitekq_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -98,6 +102,27 @@ diverite_nitekq_parser_create (dc_parser_t **out, dc_context_t *context)
 }
 
 
+static dc_status_t
+diverite_nitekq_parser_reset (dc_parser_t *abstract)
+{
+	diverite_nitekq_parser_t *parser = (diverite_nitekq_parser_t *) abstract;
+
+	// Reset the cache.
+	parser->cached = 0;
+	parser->divemode = DC_DIVEMODE_OC;
+	parser->metric = 0;
+	parser->divetime = 0;
+	parser->maxdepth = 0.0;
+	parser->ngasmixes = 0;
+	for (unsigned int i = 0; i < NGASMIXES; ++i) {
+		parser->o2[i] = 0;
+		parser->he[i] = 0;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 static dc_status_t
 diverite_nitekq_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
 {
@@ -79,6 +79,7 @@ struct divesystem_idive_parser_t {
 };
 
 static dc_status_t divesystem_idive_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t divesystem_idive_parser_reset (dc_parser_t *abstract);
 static dc_status_t divesystem_idive_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t divesystem_idive_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t divesystem_idive_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -87,9 +88,12 @@ static const dc_parser_vtable_t divesystem_idive_parser_vtable = {
 	sizeof(divesystem_idive_parser_t),
 	DC_FAMILY_DIVESYSTEM_IDIVE,
 	divesystem_idive_parser_set_data, /* set_data */
+	divesystem_idive_parser_reset, /* reset */
 	divesystem_idive_parser_get_datetime, /* datetime */
 	divesystem_idive_parser_get_field, /* fields */
+	NULL, /* summary */
 	divesystem_idive_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -139,7 +143,7 @@ divesystem_idive_parser_create (dc_parser_t **out, dc_context_t *context, unsign
 
 
 static dc_status_t
-divesystem_idive_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+divesystem_idive_parser_reset (dc_parser_t *abstract)
 {
 	divesystem_idive_parser_t *parser = (divesystem_idive_parser_t *) abstract;
 
@@ -163,6 +167,12 @@ divesystem_idive_parser_set_data (dc_parser_t *abstract, const unsigned char *da
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+divesystem_idive_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
 
 static dc_status_t
 divesystem_idive_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
@@ -1,59 +1,206 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
 
 #include "parser-private.h"
 #include "field-cache.h"
 
+#define CHUNKSIZE 1024
+
+/*
+ * The string values live in a simple bump arena: a list of
+ * chunks that are filled one after the other. Clearing the
+ * cache just rewinds the arena, so the chunks get reused for
+ * the next dive, and adding strings doesn't need any malloc()
+ * or free() once the arena is big enough.
+ */
+struct dc_field_chunk {
+	struct dc_field_chunk *next;
+	size_t size;
+	char data[];
+};
+
+static void *dc_field_alloc(dc_field_cache_t *cache, size_t size)
+{
+	struct dc_field_chunk *chunk = cache->chunk;
+	void *ptr;
+
+	// Keep everything pointer aligned
+	size = (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+	if (!chunk || cache->used + size > chunk->size) {
+		struct dc_field_chunk *next = chunk ? chunk->next : cache->chunks;
+
+		// Insert a new chunk if the next one is missing or too small
+		if (!next || size > next->size) {
+			size_t n = size > CHUNKSIZE ? size : CHUNKSIZE;
+			struct dc_field_chunk *add = (struct dc_field_chunk *) malloc(sizeof(*add) + n);
+			if (!add)
+				return NULL;
+			add->size = n;
+			add->next = next;
+			if (chunk)
+				chunk->next = add;
+			else
+				cache->chunks = add;
+			next = add;
+		}
+
+		cache->chunk = chunk = next;
+		cache->used = 0;
+	}
+
+	ptr = chunk->data + cache->used;
+	cache->used += size;
+	return ptr;
+}
+
+/*
+ * Reserve the next string slot. The slot array is allocated
+ * from the arena too, and doubled when it runs full. The old
+ * array is simply abandoned until the arena gets rewound.
+ */
+static dc_field_string_t *dc_field_new_string(dc_field_cache_t *cache)
+{
+	if (cache->nstrings == cache->maxstrings) {
+		unsigned int max = cache->maxstrings ? cache->maxstrings * 2 : 8;
+		dc_field_string_t *strings;
+
+		if (cache->maxstrings >= MAXSTRINGS)
+			return NULL;
+		if (max > MAXSTRINGS)
+			max = MAXSTRINGS;
+
+		strings = (dc_field_string_t *) dc_field_alloc(cache, max * sizeof(*strings));
+		if (!strings)
+			return NULL;
+		if (cache->nstrings)
+			memcpy(strings, cache->strings, cache->nstrings * sizeof(*strings));
+		cache->strings = strings;
+		cache->maxstrings = max;
+	}
+
+	return cache->strings + cache->nstrings;
+}
+
 /*
  * The field cache 'string' interface has some simple rules:
  * the "descriptor" part is assumed to be a static allocation,
  * while the "value" is something that this interface will
- * alway sallocate with 'strdup()', so you can generate it
+ * always copy into the arena, so you can generate it
  * dynamically on the stack or whatever without having to
- * worry about it.
+ * worry about it. The copy stays valid until the cache
+ * is cleared.
  */
 dc_status_t dc_field_add_string(dc_field_cache_t *cache, const char *desc, const char *value)
 {
-	int i;
+	dc_field_string_t *str;
+	size_t len = strlen(value) + 1;
+	char *copy;
 
 	cache->initialized |= 1 << DC_FIELD_STRING;
-	for (i = 0; i < MAXSTRINGS; i++) {
-		dc_field_string_t *str = cache->strings+i;
-		if (str->desc)
-			continue;
-		str->value = strdup(value);
-		if (!str->value)
-			return DC_STATUS_NOMEMORY;
-		str->desc = desc;
-		return DC_STATUS_SUCCESS;
+	str = dc_field_new_string(cache);
+	if (!str)
+		return DC_STATUS_INVALIDARGS;
+	copy = (char *) dc_field_alloc(cache, len);
+	if (!copy)
+		return DC_STATUS_NOMEMORY;
+	memcpy(copy, value, len);
+	str->desc = desc;
+	str->value = copy;
+	cache->nstrings++;
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * Clear the cache so it can be reused for the next dive.
+ * The arena is only rewound, not released.
+ */
+void dc_field_clear(dc_field_cache_t *cache)
+{
+	struct dc_field_chunk *chunks = cache->chunks;
+
+	memset(cache, 0, sizeof(*cache));
+	cache->chunks = chunks;
+}
+
+/*
+ * Release the arena when the parser goes away.
+ */
+void dc_field_free(dc_field_cache_t *cache)
+{
+	struct dc_field_chunk *chunk = cache->chunks;
+
+	while (chunk) {
+		struct dc_field_chunk *next = chunk->next;
+		free(chunk);
+		chunk = next;
 	}
-	return DC_STATUS_INVALIDARGS;
+	memset(cache, 0, sizeof(*cache));
 }
 
+/*
+ * Format straight into the arena. Only when the value doesn't
+ * fit in the current chunk, it's formatted a second time into
+ * a big enough allocation.
+ */
 dc_status_t dc_field_add_string_fmt(dc_field_cache_t *cache, const char *desc, const char *fmt, ...)
 {
-	char buffer[256];
+	dc_field_string_t *str;
+	char *buffer = NULL;
+	size_t avail = 0;
 	va_list ap;
+	int len;
+
+	cache->initialized |= 1 << DC_FIELD_STRING;
+	str = dc_field_new_string(cache);
+	if (!str)
+		return DC_STATUS_INVALIDARGS;
+
+	if (cache->chunk && cache->used < cache->chunk->size) {
+		buffer = cache->chunk->data + cache->used;
+		avail = cache->chunk->size - cache->used;
+	}
 
-	/*
-	 * We ignore the return value from vsnprintf, and we
-	 * always NUL-terminate the destination buffer ourselves.
-	 *
-	 * That way we don't have to worry about random bad legacy
-	 * implementations.
-	 */
 	va_start(ap, fmt);
-	buffer[sizeof(buffer)-1] = 0;
-	(void) vsnprintf(buffer, sizeof(buffer)-1, fmt, ap);
+	len = vsnprintf(buffer, avail, fmt, ap);
 	va_end(ap);
 
-	return dc_field_add_string(cache, desc, buffer);
+	/*
+	 * Some bad legacy implementations return a negative value
+	 * on truncation instead of the required length. Fall back
+	 * to a fixed size buffer, and NUL-terminate it ourselves.
+	 */
+	if (len < 0) {
+		buffer = (char *) dc_field_alloc(cache, 256);
+		if (!buffer)
+			return DC_STATUS_NOMEMORY;
+		va_start(ap, fmt);
+		buffer[255] = 0;
+		(void) vsnprintf(buffer, 255, fmt, ap);
+		va_end(ap);
+	} else if ((size_t) len < avail) {
+		// Already in place, just claim it
+		dc_field_alloc(cache, len + 1);
+	} else {
+		buffer = (char *) dc_field_alloc(cache, len + 1);
+		if (!buffer)
+			return DC_STATUS_NOMEMORY;
+		va_start(ap, fmt);
+		(void) vsnprintf(buffer, len + 1, fmt, ap);
+		va_end(ap);
+	}
+
+	str->desc = desc;
+	str->value = buffer;
+	cache->nstrings++;
+	return DC_STATUS_SUCCESS;
 }
 
 dc_status_t dc_field_get_string(dc_field_cache_t *cache, unsigned idx, dc_field_string_t *value)
 {
-	if (idx < MAXSTRINGS) {
+	if (idx < cache->nstrings) {
 		dc_field_string_t *res = cache->strings+idx;
 		if (res->desc && res->value) {
 			*value = *res;
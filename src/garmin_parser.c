@@ -35,13 +35,37 @@
 #define MAXFIELDS 128
 
 struct msg_desc;
+struct field_desc;
 
 // Local types
+#define MSG_NAME_LEN 16
+
+// Field flags
+#define FIELD_STRING	1	// Must be NUL terminated
+#define FIELD_SKIP	2	// Not decoded at all
+
+// How to decode one field of a data record. The definition record
+// is compiled into these once, so that the data records only need
+// to dispatch to the handlers.
+struct field_plan {
+	const struct field_desc *desc;	// NULL for unknown fields
+	unsigned char field_nr, len, base_type, flags;
+};
+
 struct type_desc {
 	const char *msg_name;
 	const struct msg_desc *msg_desc;
 	unsigned char nrfields;
-	unsigned char fields[MAXFIELDS][3];
+	struct field_plan fields[MAXFIELDS];
+
+	// Size of the data records, including any developer fields
+	unsigned int size;
+
+	// Offset of the timestamp field, or -1 if there is none
+	int timestamp;
+
+	// Name storage for messages we don't know about
+	char unknown_name[MSG_NAME_LEN];
 };
 
 // Positions are signed 32-bit values, turning
@@ -66,11 +90,10 @@ struct garmin_sensor {
 // and sent together.
 struct record_data {
 	unsigned int pending;
-	unsigned int time;
 
 	// RECORD_DECO
 	int stop_time;
-	double ceiling;
+	unsigned int ceiling;	// mm
 
 	// RECORD_GASMIX
 	int index, gas_status;
@@ -100,11 +123,32 @@ struct record_data {
 #define RECORD_SENSOR_PROFILE	32
 #define RECORD_TANK_UPDATE	64
 
+// The samples are decoded once, while walking the FIT data for the
+// field cache, into a compact stream that the sample walk just replays.
+enum garmin_stream_kind {
+	STREAM_TIMESTAMP,	// value: FIT timestamp
+	STREAM_DEPTH,		// value: mm
+	STREAM_HEARTBEAT,	// value: bpm
+	STREAM_TEMPERATURE,	// value: signed degrees C
+	STREAM_TTS,		// value: s
+	STREAM_NDL,		// value: s
+	STREAM_CNS,		// value: percent
+	STREAM_DECOSTOP,	// value: stop time (s), extra: ceiling (mm)
+	STREAM_EVENT,		// value: event, extra: event data
+	STREAM_PRESSURE,	// value: sensor id, extra: 100 * bar
+};
+
+struct garmin_stream_entry {
+	unsigned int kind;
+	unsigned int value, extra;
+};
+
 typedef struct garmin_parser_t {
 	dc_parser_t base;
 
-	dc_sample_callback_t callback;
-	void *userdata;
+	// Decoded sample stream
+	dc_buffer_t *stream;
+	dc_status_t status;
 
 	// Multi-value record data
 	struct record_data record_data;
@@ -143,6 +187,14 @@ typedef struct garmin_parser_t {
 	struct dc_field_cache cache;
 } garmin_parser_t;
 
+static void stream_append(garmin_parser_t *garmin, unsigned int kind, unsigned int value, unsigned int extra)
+{
+	struct garmin_stream_entry entry = { kind, value, extra };
+
+	if (!dc_buffer_append(garmin->stream, (const unsigned char *) &entry, sizeof(entry)))
+		garmin->status = DC_STATUS_NOMEMORY;
+}
+
 typedef int (*garmin_data_cb_t)(unsigned char type, const unsigned char *data, int len, void *user);
 
 static inline struct garmin_sensor *current_sensor(garmin_parser_t *garmin)
@@ -160,43 +212,46 @@ static int find_tank_index(garmin_parser_t *garmin, unsigned int sensor_id)
 }
 
 /*
- * Decode the event. Numbers from Wojtek's fit2subs python script
+ * The events. Numbers from Wojtek's fit2subs python script
+ */
+static const struct {
+	// 1 - state, 2 - notify, 3 - warning, 4 - alarm
+	int severity;
+	const char *name;
+} garmin_event_desc[] = {
+	[0] =  { 2, "Deco required" },
+	[1] =  { 2, "Gas Switch prompted" },
+	[2] =  { 1, "Surface" },
+	[3] =  { 2, "Approaching NDL" },
+	[4] =  { 3, "ppO2 warning" },
+	[5] =  { 4, "ppO2 critical high" },
+	[6] =  { 4, "ppO2 critical low" },
+	[7] =  { 2, "Time alert" },
+	[8] =  { 2, "Depth alert" },
+	[9] =  { 3, "Deco ceiling broken" },
+	[10] = { 1, "Deco completed" },
+	[11] = { 3, "Safety stop ceiling broken" },
+	[12] = { 1, "Safety stop completed" },
+	[13] = { 3, "CNS warning" },
+	[14] = { 4, "CNS critical" },
+	[15] = { 3, "OTU warning" },
+	[16] = { 4, "OTU critical" },
+	[17] = { 3, "Ascent speed critical" },
+	[18] = { 1, "Alert dismissed" },
+	[19] = { 1, "Alert timed out" },
+	[20] = { 3, "Battry Low" },
+	[21] = { 3, "Battry Critical" },
+	[22] = { 1, "Safety stop begin" },
+	[23] = { 1, "Approaching deco stop" },
+	[32] = { 1, "Tank battery low" },	// No way to know which tank
+};
+
+/*
+ * Decode the event.
  */
-static void garmin_event(struct garmin_parser_t *garmin,
-		unsigned char event, unsigned char type, unsigned char group,
-		unsigned int data, unsigned int unknown)
+static void garmin_event(unsigned char event, unsigned int data,
+		dc_sample_callback_t callback, void *userdata)
 {
-	static const struct {
-		// 1 - state, 2 - notify, 3 - warning, 4 - alarm
-		int severity;
-		const char *name;
-	} event_desc[] = {
-		[0] =  { 2, "Deco required" },
-		[1] =  { 2, "Gas Switch prompted" },
-		[2] =  { 1, "Surface" },
-		[3] =  { 2, "Approaching NDL" },
-		[4] =  { 3, "ppO2 warning" },
-		[5] =  { 4, "ppO2 critical high" },
-		[6] =  { 4, "ppO2 critical low" },
-		[7] =  { 2, "Time alert" },
-		[8] =  { 2, "Depth alert" },
-		[9] =  { 3, "Deco ceiling broken" },
-		[10] = { 1, "Deco completed" },
-		[11] = { 3, "Safety stop ceiling broken" },
-		[12] = { 1, "Safety stop completed" },
-		[13] = { 3, "CNS warning" },
-		[14] = { 4, "CNS critical" },
-		[15] = { 3, "OTU warning" },
-		[16] = { 4, "OTU critical" },
-		[17] = { 3, "Ascent speed critical" },
-		[18] = { 1, "Alert dismissed" },
-		[19] = { 1, "Alert timed out" },
-		[20] = { 3, "Battry Low" },
-		[21] = { 3, "Battry Critical" },
-		[22] = { 1, "Safety stop begin" },
-		[23] = { 1, "Approaching deco stop" },
-		[32] = { 1, "Tank battery low" },	// No way to know which tank
-	};
 	dc_sample_value_t sample = {0};
 
 	switch (event) {
@@ -205,20 +260,20 @@ static void garmin_event(struct garmin_parser_t *garmin,
 	case 48:
 		break;
 	case 56:
-		if (data >= C_ARRAY_SIZE(event_desc))
+		if (data >= C_ARRAY_SIZE(garmin_event_desc))
 			return;
 
 		sample.event.type = SAMPLE_EVENT_STRING;
-		sample.event.name = event_desc[data].name;
-		sample.event.flags =  event_desc[data].severity << SAMPLE_FLAGS_SEVERITY_SHIFT;
+		sample.event.name = garmin_event_desc[data].name;
+		sample.event.flags =  garmin_event_desc[data].severity << SAMPLE_FLAGS_SEVERITY_SHIFT;
 		if (!sample.event.name)
 			return;
-		garmin->callback(DC_SAMPLE_EVENT, sample, garmin->userdata);
+		callback(DC_SAMPLE_EVENT, sample, userdata);
 		return;
 
 	case 57:
 		sample.gasmix = data - 1;
-		garmin->callback(DC_SAMPLE_GASMIX, sample, garmin->userdata);
+		callback(DC_SAMPLE_GASMIX, sample, userdata);
 		return;
 	}
 }
@@ -236,79 +291,71 @@ static void flush_pending_record(struct garmin_parser_t *garmin)
 	unsigned int pending = record->pending;
 
 	record->pending = 0;
-	if (!garmin->callback) {
-		if (pending & RECORD_GASMIX) {
-			// 0 - disabled, 1 - enabled, 2 - backup
-			int enabled = record->gas_status > 0;
-			int index = record->index;
-			if (enabled && index < MAXGASES) {
-				DC_ASSIGN_IDX(garmin->cache, GASMIX, index, record->gasmix);
-				DC_ASSIGN_FIELD(garmin->cache, GASMIX_COUNT, index+1);
-			}
+	if (pending & RECORD_GASMIX) {
+		// 0 - disabled, 1 - enabled, 2 - backup
+		int enabled = record->gas_status > 0;
+		int index = record->index;
+		if (enabled && index < MAXGASES) {
+			DC_ASSIGN_IDX(garmin->cache, GASMIX, index, record->gasmix);
+			DC_ASSIGN_FIELD(garmin->cache, GASMIX_COUNT, index+1);
 		}
-		if (pending & RECORD_DEVICE_INFO && record->device_index == 0) {
-			garmin->dive.firmware = record->firmware;
-			garmin->dive.serial = record->serial;
-			garmin->dive.product = record->product;
-		}
-		if (pending & RECORD_DECO_MODEL)
-			dc_field_add_string_fmt(&garmin->cache, "Deco model", "Buhlmann ZHL-16C %u/%u", record->gf_low, record->gf_high);
-
-		// End of sensor record just increments nr_sensor,
-		// so that the next sensor record will start
-		// filling in the next one.
-		//
-		// NOTE! This only happens for tank pods, other
-		// sensors will just overwrite each other.
-		//
-		// Also note that the last sensor is just for
-		// scratch use, so that the sensor record can
-		// always fill in dive.sensor[nr_sensor] with
-		// no checking.
-		if (pending & RECORD_SENSOR_PROFILE) {
-			if (garmin->dive.nr_sensor < MAX_SENSORS-1)
-				garmin->dive.nr_sensor++;
-		}
-
-		return;
 	}
-
-	if (pending &  RECORD_DECO) {
-		dc_sample_value_t sample = {0};
-		sample.deco.type = DC_DECO_DECOSTOP;
-		sample.deco.time = record->stop_time;
-		sample.deco.depth = record->ceiling;
-		garmin->callback(DC_SAMPLE_DECO, sample, garmin->userdata);
+	if (pending & RECORD_DEVICE_INFO && record->device_index == 0) {
+		garmin->dive.firmware = record->firmware;
+		garmin->dive.serial = record->serial;
+		garmin->dive.product = record->product;
 	}
+	if (pending & RECORD_DECO_MODEL)
+		dc_field_add_string_fmt(&garmin->cache, "Deco model", "Buhlmann ZHL-16C %u/%u", record->gf_low, record->gf_high);
 
-	if (pending & RECORD_EVENT) {
-		garmin_event(garmin, record->event_nr, record->event_type,
-			record->event_group, record->event_data, record->event_unknown);
+	// End of sensor record just increments nr_sensor,
+	// so that the next sensor record will start
+	// filling in the next one.
+	//
+	// NOTE! This only happens for tank pods, other
+	// sensors will just overwrite each other.
+	//
+	// Also note that the last sensor is just for
+	// scratch use, so that the sensor record can
+	// always fill in dive.sensor[nr_sensor] with
+	// no checking.
+	if (pending & RECORD_SENSOR_PROFILE) {
+		if (garmin->dive.nr_sensor < MAX_SENSORS-1)
+			garmin->dive.nr_sensor++;
 	}
 
-	if (pending & RECORD_TANK_UPDATE) {
-		dc_sample_value_t sample = {0};
+	if (pending & RECORD_DECO)
+		stream_append(garmin, STREAM_DECOSTOP, record->stop_time, record->ceiling);
 
-		sample.pressure.tank = find_tank_index(garmin, record->sensor);
-		sample.pressure.value = record->pressure / 100.0;
-		garmin->callback(DC_SAMPLE_PRESSURE, sample, garmin->userdata);
-	}
+	if (pending & RECORD_EVENT)
+		stream_append(garmin, STREAM_EVENT, record->event_nr, record->event_data);
+
+	// The sensor is matched up with its tank when replaying,
+	// because the sensor profiles may come after the samples.
+	if (pending & RECORD_TANK_UPDATE)
+		stream_append(garmin, STREAM_PRESSURE, record->sensor, record->pressure);
 }
 
 
 static dc_status_t garmin_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t garmin_parser_reset (dc_parser_t *abstract);
 static dc_status_t garmin_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t garmin_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t garmin_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t garmin_parser_samples_batch (dc_parser_t *abstract, dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata);
+static dc_status_t garmin_parser_destroy (dc_parser_t *abstract);
 
 static const dc_parser_vtable_t garmin_parser_vtable = {
 	sizeof(garmin_parser_t),
 	DC_FAMILY_GARMIN,
 	garmin_parser_set_data, /* set_data */
+	garmin_parser_reset, /* reset */
 	garmin_parser_get_datetime, /* datetime */
 	garmin_parser_get_field, /* fields */
+	NULL, /* summary */
 	garmin_parser_samples_foreach, /* samples_foreach */
-	NULL /* destroy */
+	garmin_parser_samples_batch, /* samples_batch */
+	garmin_parser_destroy /* destroy */
 };
 
 dc_status_t
@@ -326,6 +373,19 @@ garmin_parser_create (dc_parser_t **out, dc_context_t *context)
 		return DC_STATUS_NOMEMORY;
 	}
 
+	parser->stream = dc_buffer_new (0);
+	if (parser->stream == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		dc_parser_deallocate ((dc_parser_t *) parser);
+		return DC_STATUS_NOMEMORY;
+	}
+	parser->status = DC_STATUS_SUCCESS;
+	memset(&parser->record_data, 0, sizeof(parser->record_data));
+	memset(parser->type_desc, 0, sizeof(parser->type_desc));
+	memset(&parser->dive, 0, sizeof(parser->dive));
+	memset(&parser->gps, 0, sizeof(parser->gps));
+	memset(&parser->cache, 0, sizeof(parser->cache));
+
 	*out = (dc_parser_t *) parser;
 
 	return DC_STATUS_SUCCESS;
@@ -389,46 +449,33 @@ static const struct {
  */
 struct field_desc {
 	const char *name;
-	void (*parse)(struct garmin_parser_t *, unsigned char base_type, const unsigned char *data);
+	const char *type_name;
+	unsigned int size;
+	void (*parse)(struct garmin_parser_t *, const unsigned char *data);
 };
 
 #define DECLARE_FIELD(msg, name, type) __DECLARE_FIELD(msg##_##name, type)
 #define __DECLARE_FIELD(name, type) \
 	static void parse_##name(struct garmin_parser_t *, const type); \
-	static void parse_##name##_##type(struct garmin_parser_t *g, unsigned char base_type, const unsigned char *p) \
+	static void parse_##name##_##type(struct garmin_parser_t *g, const unsigned char *p) \
 	{ \
-		if (strcmp(#type, base_type_info[base_type].type_name)) \
-			fprintf(stderr, "%s: %s should be %s\n", #name, #type, base_type_info[base_type].type_name); \
 		type val = *(type *)p; \
 		if (val == type##_INVAL) return; \
 		DEBUG(g->base.context, "%s (%s): %lld", #name, #type, (long long)val); \
 		parse_##name(g, *(type *)p); \
 	} \
-	static const struct field_desc name##_field_##type = { #name, parse_##name##_##type }; \
+	static const struct field_desc name##_field_##type = { #name, #type, sizeof(type), parse_##name##_##type }; \
 	static void parse_##name(struct garmin_parser_t *garmin, type data)
 
 // All msg formats can have a timestamp
 // Garmin timestamps are in seconds since 00:00 Dec 31 1989 UTC
 // Convert to "standard epoch time" by adding 631065600.
+//
+// The session start time usually comes after the samples, so the
+// timestamps are made relative to it only when replaying them.
 DECLARE_FIELD(ANY, timestamp, UINT32)
 {
-	if (garmin->callback) {
-		dc_sample_value_t sample = {0};
-
-		// Turn the timestamp relative to the beginning of the dive
-		if (data < garmin->dive.time)
-			return;
-		data -= garmin->dive.time;
-
-		// Did we already do this?
-		if (data < garmin->record_data.time)
-			return;
-
-		// Now we're ready to actually update the sample times
-		garmin->record_data.time = data+1;
-		sample.time = data;
-		garmin->callback(DC_SAMPLE_TIME, sample, garmin->userdata);
-	}
+	stream_append(garmin, STREAM_TIMESTAMP, data, 0);
 }
 DECLARE_FIELD(ANY, message_index, UINT16)	{ garmin->record_data.index = data; }
 DECLARE_FIELD(ANY, part_index, UINT32)		{ garmin->record_data.index = data; }
@@ -470,34 +517,22 @@ DECLARE_FIELD(RECORD, position_long, SINT32)	{ garmin->gps.RECORD.lon = data; }
 DECLARE_FIELD(RECORD, altitude, UINT16) { }		// 5 *m + 500 ?
 DECLARE_FIELD(RECORD, heart_rate, UINT8)		// bpm
 {
-	if (garmin->callback) {
-		dc_sample_value_t sample = {0};
-		sample.heartbeat = data;
-		garmin->callback(DC_SAMPLE_HEARTBEAT, sample, garmin->userdata);
-	}
+	stream_append(garmin, STREAM_HEARTBEAT, data, 0);
 }
 DECLARE_FIELD(RECORD, distance, UINT32) { }		// Distance in 100 * m? WTF?
 DECLARE_FIELD(RECORD, temperature, SINT8)		// degrees C
 {
-	if (garmin->callback) {
-		dc_sample_value_t sample = {0};
-		sample.temperature = data;
-		garmin->callback(DC_SAMPLE_TEMPERATURE, sample, garmin->userdata);
-	}
+	stream_append(garmin, STREAM_TEMPERATURE, data, 0);
 }
 DECLARE_FIELD(RECORD, abs_pressure, UINT32) {}		// Pascal
 DECLARE_FIELD(RECORD, depth, UINT32)			// mm
 {
-	if (garmin->callback) {
-		dc_sample_value_t sample = {0};
-		sample.depth = data / 1000.0;
-		garmin->callback(DC_SAMPLE_DEPTH, sample, garmin->userdata);
-	}
+	stream_append(garmin, STREAM_DEPTH, data, 0);
 }
 DECLARE_FIELD(RECORD, next_stop_depth, UINT32)		// mm
 {
 	garmin->record_data.pending |= RECORD_DECO;
-	garmin->record_data.ceiling = data / 1000.0;
+	garmin->record_data.ceiling = data;
 }
 DECLARE_FIELD(RECORD, next_stop_time, UINT32)		// seconds
 {
@@ -506,28 +541,15 @@ DECLARE_FIELD(RECORD, next_stop_time, UINT32)		// seconds
 }
 DECLARE_FIELD(RECORD, tts, UINT32)
 {
-	if (garmin->callback) {
-		dc_sample_value_t sample = {0};
-		sample.time = data;
-		garmin->callback(DC_SAMPLE_TTS, sample, garmin->userdata);
-	}
+	stream_append(garmin, STREAM_TTS, data, 0);
 }
 DECLARE_FIELD(RECORD, ndl, UINT32)			// s
 {
-	if (garmin->callback) {
-		dc_sample_value_t sample = {0};
-		sample.deco.type = DC_DECO_NDL;
-		sample.deco.time = data;
-		garmin->callback(DC_SAMPLE_DECO, sample, garmin->userdata);
-	}
+	stream_append(garmin, STREAM_NDL, data, 0);
 }
 DECLARE_FIELD(RECORD, cns_load, UINT8)
 {
-	if (garmin->callback) {
-		dc_sample_value_t sample = {0};
-		sample.cns = data / 100.0;
-		garmin->callback(DC_SAMPLE_CNS, sample, garmin->userdata);
-	}
+	stream_append(garmin, STREAM_CNS, data, 0);
 }
 DECLARE_FIELD(RECORD, n2_load, UINT16) { }		// percent
 DECLARE_FIELD(RECORD, air_time_remaining, UINT32) { }	// seconds
@@ -989,36 +1011,27 @@ static const struct {
 	SET_MESG(323, TANK_SUMMARY),
 };
 
-#define MSG_NAME_LEN 16
-static const struct msg_desc *lookup_msg_desc(unsigned short msg, int local, const char **namep)
-{
-	static struct msg_desc local_array[16];
-	static char local_name[16][MSG_NAME_LEN];
-	struct msg_desc *desc;
-	char *name;
+// Unknown messages have no known fields at all
+static const struct msg_desc unknown_msg_desc = { 0 };
 
+/*
+ * Look up the message descriptor for a local type definition.
+ * Unknown messages get a generated name, which lives in the
+ * type descriptor itself, so nothing is shared between parsers.
+ */
+static void lookup_msg_desc(unsigned short msg, struct type_desc *desc)
+{
 	/* Do we have a real one? */
 	if (msg < C_ARRAY_SIZE(message_array) && message_array[msg].name) {
-		*namep = message_array[msg].name;
-		return message_array[msg].desc;
+		desc->msg_name = message_array[msg].name;
+		desc->msg_desc = message_array[msg].desc;
+		return;
 	}
 
 	/* If not, fake it */
-	desc = &local_array[local];
-	memset(desc, 0, sizeof(*desc));
-
-	name = local_name[local];
-	snprintf(name, MSG_NAME_LEN, "msg-%d", msg);
-	*namep = name;
-	return desc;
-}
-
-static int traverse_compressed(struct garmin_parser_t *garmin,
-	const unsigned char *data, unsigned int size,
-	unsigned char type, unsigned int time)
-{
-	fprintf(stderr, "Compressed record for local type %d:\n", type);
-	return -1;
+	snprintf(desc->unknown_name, MSG_NAME_LEN, "msg-%d", msg);
+	desc->msg_name = desc->unknown_name;
+	desc->msg_desc = &unknown_msg_desc;
 }
 
 static int all_data_inval(const unsigned char *data, int base_type, int len)
@@ -1085,94 +1098,152 @@ static void unknown_field(struct garmin_parser_t *garmin, const unsigned char *d
 }
 
 
+/*
+ * Decode the fields of a data record, using the plan that
+ * was compiled from its definition record.
+ */
+static int traverse_fields(struct garmin_parser_t *garmin,
+	const struct type_desc *desc,
+	const unsigned char *data, unsigned int size)
+{
+	if (size < desc->size) {
+		ERROR(garmin->base.context, "Data traversal size bigger than remaining data (%d vs %d)\n", desc->size, size);
+		return -1;
+	}
+
+	for (int i = 0; i < desc->nrfields; i++) {
+		const struct field_plan *plan = desc->fields + i;
+
+		if ((plan->flags & FIELD_STRING) && !memchr(data, 0, plan->len)) {
+			ERROR(garmin->base.context, "Data traversal string bigger than field (%d)\n", plan->len);
+			return -1;
+		}
+
+		if (plan->desc) {
+			plan->desc->parse(garmin, data);
+		} else if (!(plan->flags & FIELD_SKIP)) {
+			unknown_field(garmin, data, desc->msg_name, plan->field_nr, plan->base_type, plan->len);
+		}
+
+		data += plan->len;
+	}
+
+	return desc->size;
+}
+
+/*
+ * A compressed timestamp record has the low bits of the timestamp in
+ * the record header, and otherwise looks just like a regular record
+ * of the (small) local type.
+ */
+static int traverse_compressed(struct garmin_parser_t *garmin,
+	const unsigned char *data, unsigned int size,
+	unsigned char type, unsigned int time)
+{
+	struct type_desc *desc = garmin->type_desc + type;
+
+	if (!desc->msg_desc) {
+		ERROR(garmin->base.context, "Uninitialized type descriptor %d\n", type);
+		return -1;
+	}
+
+	parse_ANY_timestamp(garmin, time);
+
+	return traverse_fields(garmin, desc, data, size);
+}
+
 static int traverse_regular(struct garmin_parser_t *garmin,
 	const unsigned char *data, unsigned int size,
 	unsigned char type, unsigned int *timep)
 {
-	unsigned int total_len = 0;
 	struct type_desc *desc = garmin->type_desc + type;
-	const struct msg_desc *msg_desc = desc->msg_desc;
-	const char *msg_name = desc->msg_name;
 
-	if (!msg_desc) {
+	if (!desc->msg_desc) {
 		ERROR(garmin->base.context, "Uninitialized type descriptor %d\n", type);
 		return -1;
 	}
 
-	for (int i = 0; i < desc->nrfields; i++) {
-		const unsigned char *field = desc->fields[i];
-		unsigned int field_nr = field[0];
-		unsigned int len = field[1];
-		unsigned int base_type = field[2] & 0x7f;
-		const struct field_desc *field_desc;
-		unsigned int base_size;
-
-		if (!len) {
-			ERROR(garmin->base.context, "field with zero length\n");
-			return -1;
-		}
+	// Later compressed timestamps are relative to this one
+	if (desc->timestamp >= 0 && size >= desc->size) {
+		unsigned int timestamp = array_uint32_le(data + desc->timestamp);
+		if (timestamp != UINT32_INVAL)
+			*timep = timestamp;
+	}
 
-		if (size < len) {
-			ERROR(garmin->base.context, "Data traversal size bigger than remaining data (%d vs %d)\n", len, size);
-			return -1;
-		}
+	return traverse_fields(garmin, desc, data, size);
+}
 
-		if (base_type > 16) {
-			ERROR(garmin->base.context, "Unknown base type %d\n", base_type);
-			data += size;
-			len -= size;
-			total_len += size;
-			continue;
-		}
-		base_size = base_type_info[base_type].type_size;
-		if (len % base_size) {
-			ERROR(garmin->base.context, "Data traversal size not a multiple of base size (%d vs %d)\n", len, base_size);
-			return -1;
-		}
-		// String
-		if (base_type == 7) {
-			int string_len = strnlen(data, size);
-			if (string_len >= size) {
-				ERROR(garmin->base.context, "Data traversal string bigger than remaining data\n");
-				return -1;
-			}
-			if (len <= string_len) {
-				ERROR(garmin->base.context, "field length %d, string length %d\n", len, string_len + 1);
-				return -1;
-			}
-		}
+/*
+ * Look up the decoder for a field, and check everything
+ * that does not depend on the actual field data.
+ */
+static int compile_field(struct garmin_parser_t *garmin,
+	struct type_desc *desc, struct field_plan *plan,
+	const unsigned char field[3])
+{
+	const struct msg_desc *msg_desc = desc->msg_desc;
+	const struct field_desc *field_desc;
+	unsigned int field_nr = field[0];
+	unsigned int len = field[1];
+	unsigned int base_type = field[2] & 0x7f;
+	unsigned int base_size;
+
+	plan->desc = NULL;
+	plan->field_nr = field_nr;
+	plan->len = len;
+	plan->base_type = base_type;
+	plan->flags = 0;
+
+	if (!len) {
+		ERROR(garmin->base.context, "field with zero length\n");
+		return -1;
+	}
 
+	if (base_type > 16) {
+		ERROR(garmin->base.context, "Unknown base type %d\n", base_type);
+		plan->flags = FIELD_SKIP;
+		return 0;
+	}
+	base_size = base_type_info[base_type].type_size;
+	if (len % base_size) {
+		ERROR(garmin->base.context, "Data traversal size not a multiple of base size (%d vs %d)\n", len, base_size);
+		return -1;
+	}
+	// String
+	if (base_type == 7)
+		plan->flags = FIELD_STRING;
+
+	// Certain field numbers have fixed meaning across all messages
+	switch (field_nr) {
+	case 250:
+		field_desc = &ANY_part_index_field_UINT32;
+		break;
+	case 253:
+		field_desc = &ANY_timestamp_field_UINT32;
+		break;
+	case 254:
+		field_desc = &ANY_message_index_field_UINT16;
+		break;
+	default:
+		field_desc = NULL;
+		if (field_nr < msg_desc->maxfield)
+			field_desc = msg_desc->field[field_nr];
+	}
 
+	if (field_desc) {
+		if (strcmp(field_desc->type_name, base_type_info[base_type].type_name))
+			WARNING(garmin->base.context, "%s: %s should be %s\n", field_desc->name, field_desc->type_name, base_type_info[base_type].type_name);
 
-		// Certain field numbers have fixed meaning across all messages
-		switch (field_nr) {
-		case 250:
-			field_desc = &ANY_part_index_field_UINT32;
-			break;
-		case 253:
-			field_desc = &ANY_timestamp_field_UINT32;
-			break;
-		case 254:
-			field_desc = &ANY_message_index_field_UINT16;
-			break;
-		default:
+		// Too small to decode as the expected type
+		if (len < field_desc->size)
 			field_desc = NULL;
-			if (field_nr < msg_desc->maxfield)
-				field_desc = msg_desc->field[field_nr];
-		}
-
-		if (field_desc) {
-			field_desc->parse(garmin, base_type, data);
-		} else {
-			unknown_field(garmin, data, msg_name, field_nr, base_type, len);
-		}
-
-		data += len;
-		total_len += len;
-		size -= len;
 	}
+	plan->desc = field_desc;
 
-	return total_len;
+	if (field_desc == &ANY_timestamp_field_UINT32)
+		desc->timestamp = desc->size;
+
+	return 0;
 }
 
 /*
@@ -1195,6 +1266,9 @@ static int traverse_regular(struct garmin_parser_t *garmin,
  *
  *	- 1x number of developer definitions
  *	- 3 bytes each
+ *
+ * We have no developer field descriptions to interpret the developer
+ * fields with, so they only count towards the size of the data records.
  */
 static int traverse_definition(struct garmin_parser_t *garmin,
 	const unsigned char *data, unsigned int size,
@@ -1205,13 +1279,22 @@ static int traverse_definition(struct garmin_parser_t *garmin,
 	struct type_desc *desc = garmin->type_desc + type;
 	int fields, devfields, len;
 
+	if (size < 5) {
+		ERROR(garmin->base.context, "Definition record bigger than remaining data\n");
+		return -1;
+	}
+
 	msg = array_uint16_le(data+2);
-	desc->msg_desc = lookup_msg_desc(msg, type, &desc->msg_name);
+	lookup_msg_desc(msg, desc);
 	fields = data[4];
 
 	DEBUG(garmin->base.context, "Define local type %d: %02x %02x %04x %02x %s",
 		type, data[0], data[1], msg, fields, desc->msg_name);
 
+	desc->nrfields = 0;
+	desc->size = 0;
+	desc->timestamp = -1;
+
 	if (data[1]) {
 		ERROR(garmin->base.context, "Only handling little-endian definitions\n");
 		return -1;
@@ -1221,20 +1304,34 @@ static int traverse_definition(struct garmin_parser_t *garmin,
 		ERROR(garmin->base.context, "Too many fields in description: %d (max %d)\n", fields, MAXFIELDS);
 		return -1;
 	}
-	desc->nrfields = fields;
 	len = 5 + fields*3;
-	devfields = 0;
-	if (record & 0x20) {
-		devfields = data[len];
-		len += 1 + devfields*3;
-		ERROR(garmin->base.context, "NO support for developer fields yet\n");
+	if (size < len + ((record & 0x20) ? 1 : 0)) {
+		ERROR(garmin->base.context, "Definition record bigger than remaining data\n");
 		return -1;
 	}
 
 	for (int i = 0; i < fields; i++) {
-		unsigned char *field = desc->fields[i];
-		memcpy(field, data + (5+i*3), 3);
+		const unsigned char *field = data + (5+i*3);
 		DEBUG(garmin->base.context, "  %d: %02x %02x %02x", i, field[0], field[1], field[2]);
+		if (compile_field(garmin, desc, desc->fields + i, field) < 0)
+			return -1;
+		desc->size += field[1];
+	}
+	desc->nrfields = fields;
+
+	if (record & 0x20) {
+		devfields = data[len];
+		len += 1;
+		if (size < len + devfields*3) {
+			ERROR(garmin->base.context, "Definition record bigger than remaining data\n");
+			return -1;
+		}
+		for (int i = 0; i < devfields; i++) {
+			const unsigned char *field = data + (len+i*3);
+			DEBUG(garmin->base.context, "  dev %d: %02x %02x %02x", i, field[0], field[1], field[2]);
+			desc->size += field[1];
+		}
+		len += devfields*3;
 	}
 
 	return len;
@@ -1304,7 +1401,7 @@ traverse_data(struct garmin_parser_t *garmin)
 		} else {			// Normal data record
 			len = traverse_regular(garmin, data, datasize, record, &time);
 		}
-		if (len <= 0 || len > datasize)
+		if (len < 0 || len > datasize)
 			return DC_STATUS_IO;
 		data += len;
 		datasize -= len;
@@ -1390,18 +1487,41 @@ static void add_sensor_string(garmin_parser_t *garmin, const char *desc, const s
 }
 
 static dc_status_t
-garmin_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+garmin_parser_reset (dc_parser_t *abstract)
 {
 	garmin_parser_t *garmin = (garmin_parser_t *) abstract;
 
-	/* Walk the data once without a callback to set up the core fields */
-	garmin->callback = NULL;
-	garmin->userdata = NULL;
+	dc_buffer_clear(garmin->stream);
+	garmin->status = DC_STATUS_SUCCESS;
+	memset(&garmin->record_data, 0, sizeof(garmin->record_data));
+	memset(garmin->type_desc, 0, sizeof(garmin->type_desc));
 	memset(&garmin->gps, 0, sizeof(garmin->gps));
 	memset(&garmin->dive, 0, sizeof(garmin->dive));
-	memset(&garmin->cache, 0, sizeof(garmin->cache));
+	dc_field_clear(&garmin->cache);
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+garmin_parser_destroy (dc_parser_t *abstract)
+{
+	garmin_parser_t *garmin = (garmin_parser_t *) abstract;
+
+	dc_field_free(&garmin->cache);
+	dc_buffer_free(garmin->stream);
 
-	traverse_data(garmin);
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+garmin_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	garmin_parser_t *garmin = (garmin_parser_t *) abstract;
+
+	/* Walk the data once to set up the core fields and the sample stream */
+	dc_status_t rc = traverse_data(garmin);
+	if (garmin->status == DC_STATUS_SUCCESS)
+		garmin->status = rc;
 
 	// These seem to be the "real" GPS dive coordinates
 	add_gps_string(garmin, "GPS1", &garmin->gps.SESSION.entry);
@@ -1512,8 +1632,197 @@ static dc_status_t
 garmin_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
 {
 	garmin_parser_t *garmin = (garmin_parser_t *) abstract;
+	const struct garmin_stream_entry *entry = (const struct garmin_stream_entry *) dc_buffer_get_data(garmin->stream);
+	size_t count = dc_buffer_get_size(garmin->stream) / sizeof(*entry);
+	unsigned int mask = abstract->samplemask;
+	unsigned int time = 0;
+
+	if (callback == NULL)
+		return garmin->status;
+
+	for (size_t i = 0; i < count; i++, entry++) {
+		dc_sample_value_t sample = {0};
+		unsigned int value = entry->value;
+
+		switch (entry->kind) {
+		case STREAM_TIMESTAMP:
+			// Turn the timestamp relative to the beginning of the dive
+			if (value < garmin->dive.time)
+				break;
+			value -= garmin->dive.time;
+
+			// Did we already do this?
+			if (value < time)
+				break;
+
+			// Now we're ready to actually update the sample times
+			time = value+1;
+			sample.time = value;
+			callback(DC_SAMPLE_TIME, sample, userdata);
+			break;
+		case STREAM_DEPTH:
+			sample.depth = value / 1000.0;
+			callback(DC_SAMPLE_DEPTH, sample, userdata);
+			break;
+		case STREAM_HEARTBEAT:
+			if (!DC_SAMPLE_WANTED(mask, DC_SAMPLE_HEARTBEAT))
+				break;
+			sample.heartbeat = value;
+			callback(DC_SAMPLE_HEARTBEAT, sample, userdata);
+			break;
+		case STREAM_TEMPERATURE:
+			if (!DC_SAMPLE_WANTED(mask, DC_SAMPLE_TEMPERATURE))
+				break;
+			sample.temperature = (signed int) value;
+			callback(DC_SAMPLE_TEMPERATURE, sample, userdata);
+			break;
+		case STREAM_TTS:
+			if (!DC_SAMPLE_WANTED(mask, DC_SAMPLE_TTS))
+				break;
+			sample.time = value;
+			callback(DC_SAMPLE_TTS, sample, userdata);
+			break;
+		case STREAM_NDL:
+			if (!DC_SAMPLE_WANTED(mask, DC_SAMPLE_DECO))
+				break;
+			sample.deco.type = DC_DECO_NDL;
+			sample.deco.time = value;
+			callback(DC_SAMPLE_DECO, sample, userdata);
+			break;
+		case STREAM_CNS:
+			if (!DC_SAMPLE_WANTED(mask, DC_SAMPLE_CNS))
+				break;
+			sample.cns = value / 100.0;
+			callback(DC_SAMPLE_CNS, sample, userdata);
+			break;
+		case STREAM_DECOSTOP:
+			if (!DC_SAMPLE_WANTED(mask, DC_SAMPLE_DECO))
+				break;
+			sample.deco.type = DC_DECO_DECOSTOP;
+			sample.deco.time = (signed int) value;
+			sample.deco.depth = entry->extra / 1000.0;
+			callback(DC_SAMPLE_DECO, sample, userdata);
+			break;
+		case STREAM_EVENT:
+			garmin_event(value, entry->extra, callback, userdata);
+			break;
+		case STREAM_PRESSURE:
+			if (!DC_SAMPLE_WANTED(mask, DC_SAMPLE_PRESSURE))
+				break;
+			sample.pressure.tank = find_tank_index(garmin, value);
+			sample.pressure.value = entry->extra / 100.0;
+			callback(DC_SAMPLE_PRESSURE, sample, userdata);
+			break;
+		}
+	}
+
+	return garmin->status;
+}
+
+/*
+ * Fill the sample columns straight from the decoded stream, with the
+ * same sample types and values as the samples_foreach walk above.
+ */
+static dc_status_t
+garmin_parser_samples_batch (dc_parser_t *abstract, dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata)
+{
+	garmin_parser_t *garmin = (garmin_parser_t *) abstract;
+	const struct garmin_stream_entry *entry = (const struct garmin_stream_entry *) dc_buffer_get_data(garmin->stream);
+	size_t count = dc_buffer_get_size(garmin->stream) / sizeof(*entry);
+	unsigned int mask = abstract->samplemask;
+	unsigned int time = 0;
+	dc_sample_batch_writer_t writer;
+
+	dc_sample_batch_init(&writer, abstract->context, batch, callback, userdata);
+
+	for (size_t i = 0; i < count; i++, entry++) {
+		dc_sample_event_t *event = NULL;
+		unsigned int value = entry->value;
+		unsigned int row = 0;
+		unsigned int tank = 0;
+
+		switch (entry->kind) {
+		case STREAM_TIMESTAMP:
+			// Turn the timestamp relative to the beginning of the dive
+			if (value < garmin->dive.time)
+				break;
+			value -= garmin->dive.time;
+
+			// Did we already do this?
+			if (value < time)
+				break;
+
+			time = value+1;
+			if (!DC_SAMPLE_WANTED(mask, DC_SAMPLE_TIME))
+				break;
+			row = dc_sample_batch_next(&writer);
+			if (batch->time)
+				batch->time[row] = value;
+			break;
+		case STREAM_DEPTH:
+			if (!DC_SAMPLE_WANTED(mask, DC_SAMPLE_DEPTH))
+				break;
+			row = dc_sample_batch_row(&writer);
+			if (batch->depth)
+				batch->depth[row] = value / 1000.0;
+			break;
+		case STREAM_TEMPERATURE:
+			if (!DC_SAMPLE_WANTED(mask, DC_SAMPLE_TEMPERATURE))
+				break;
+			row = dc_sample_batch_row(&writer);
+			if (batch->temperature)
+				batch->temperature[row] = (signed int) value;
+			break;
+		case STREAM_NDL:
+			if (!DC_SAMPLE_WANTED(mask, DC_SAMPLE_DECO))
+				break;
+			row = dc_sample_batch_row(&writer);
+			if (batch->deco) {
+				batch->deco[row].type = DC_DECO_NDL;
+				batch->deco[row].time = value;
+				batch->deco[row].depth = 0.0;
+			}
+			break;
+		case STREAM_DECOSTOP:
+			if (!DC_SAMPLE_WANTED(mask, DC_SAMPLE_DECO))
+				break;
+			row = dc_sample_batch_row(&writer);
+			if (batch->deco) {
+				batch->deco[row].type = DC_DECO_DECOSTOP;
+				batch->deco[row].time = (signed int) value;
+				batch->deco[row].depth = entry->extra / 1000.0;
+			}
+			break;
+		case STREAM_EVENT:
+			// Only the named events have a column, not the gas changes.
+			if ((unsigned char) value != 56 ||
+				entry->extra >= C_ARRAY_SIZE(garmin_event_desc) ||
+				garmin_event_desc[entry->extra].name == NULL ||
+				!DC_SAMPLE_WANTED(mask, DC_SAMPLE_EVENT))
+				break;
+			event = dc_sample_batch_event(&writer);
+			if (event == NULL)
+				break;
+			event->type = SAMPLE_EVENT_STRING;
+			event->flags = garmin_event_desc[entry->extra].severity << SAMPLE_FLAGS_SEVERITY_SHIFT;
+			event->name = garmin_event_desc[entry->extra].name;
+			break;
+		case STREAM_PRESSURE:
+			if (!DC_SAMPLE_WANTED(mask, DC_SAMPLE_PRESSURE))
+				break;
+			row = dc_sample_batch_row(&writer);
+			tank = find_tank_index(garmin, value);
+			if (batch->pressure && tank < batch->ntanks)
+				batch->pressure[row * batch->ntanks + tank] = entry->extra / 100.0;
+			break;
+		default:
+			// No column for the other sample types.
+			break;
+		}
+	}
+
+	if (garmin->status == DC_STATUS_SUCCESS)
+		dc_sample_batch_flush(&writer);
 
-	garmin->callback = callback;
-	garmin->userdata = userdata;
-	return traverse_data(garmin);
+	return garmin->status;
 }
@@ -141,17 +141,22 @@ typedef struct hw_ostc_parser_t {
 } hw_ostc_parser_t;
 
 static dc_status_t hw_ostc_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t hw_ostc_parser_reset (dc_parser_t *abstract);
 static dc_status_t hw_ostc_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t hw_ostc_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
+static dc_status_t hw_ostc_parser_get_summary (dc_parser_t *abstract, dc_summary_t *summary);
 static dc_status_t hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
 
 static const dc_parser_vtable_t hw_ostc_parser_vtable = {
 	sizeof(hw_ostc_parser_t),
 	DC_FAMILY_HW_OSTC,
 	hw_ostc_parser_set_data, /* set_data */
+	hw_ostc_parser_reset, /* reset */
 	hw_ostc_parser_get_datetime, /* datetime */
 	hw_ostc_parser_get_field, /* fields */
+	hw_ostc_parser_get_summary, /* summary */
 	hw_ostc_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -400,7 +405,7 @@ hw_ostc3_parser_create (dc_parser_t **out, dc_context_t *context, unsigned int s
 }
 
 static dc_status_t
-hw_ostc_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+hw_ostc_parser_reset (dc_parser_t *abstract)
 {
 	hw_ostc_parser_t *parser = (hw_ostc_parser_t *) abstract;
 
@@ -422,6 +427,12 @@ hw_ostc_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsig
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+hw_ostc_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
 
 static dc_status_t
 hw_ostc_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
@@ -485,24 +496,16 @@ hw_ostc_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
 
 #define BUFLEN 32
 
+/*
+ * Get a field value. Only the header data needs to be cached, except for
+ * the gas mixes, which are only complete once the profile is cached too.
+ */
 static dc_status_t
-hw_ostc_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
+hw_ostc_parser_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
 {
 	hw_ostc_parser_t *parser = (hw_ostc_parser_t *) abstract;
 	const unsigned char *data = abstract->data;
 
-	// Cache the header data.
-	dc_status_t rc = hw_ostc_parser_cache (parser);
-	if (rc != DC_STATUS_SUCCESS)
-		return rc;
-
-	// Cache the profile data.
-	if (parser->cached < PROFILE) {
-		rc = hw_ostc_parser_samples_foreach (abstract, NULL, NULL);
-		if (rc != DC_STATUS_SUCCESS)
-			return rc;
-	}
-
 	unsigned int version = parser->version;
 	const hw_ostc_layout_t *layout = parser->layout;
 
@@ -693,6 +696,41 @@ hw_ostc_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned
 }
 
 
+static dc_status_t
+hw_ostc_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
+{
+	hw_ostc_parser_t *parser = (hw_ostc_parser_t *) abstract;
+
+	// Cache the header data.
+	dc_status_t rc = hw_ostc_parser_cache (parser);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	// Cache the profile data.
+	if (parser->cached < PROFILE) {
+		rc = hw_ostc_parser_samples_foreach (abstract, NULL, NULL);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
+	}
+
+	return hw_ostc_parser_field (abstract, type, flags, value);
+}
+
+
+static dc_status_t
+hw_ostc_parser_get_summary (dc_parser_t *abstract, dc_summary_t *summary)
+{
+	hw_ostc_parser_t *parser = (hw_ostc_parser_t *) abstract;
+
+	// Cache the header data.
+	dc_status_t rc = hw_ostc_parser_cache (parser);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	return dc_parser_fill_summary (abstract, hw_ostc_parser_field, summary);
+}
+
+
 static dc_status_t
 hw_ostc_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
 {
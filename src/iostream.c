@@ -199,6 +199,7 @@ dc_iostream_read (dc_iostream_t *iostream, void *data, size_t size, size_t *actu
 		size_t nbytes = 0;
 
 		status = iostream->vtable->read (iostream, data, size, &nbytes);
+		TRACE (iostream->context, DC_TRACE_READ, iostream->transport, 0, status, (unsigned char *) data, nbytes);
 		HEXDUMP (iostream->context, DC_LOGLEVEL_INFO, "Read", (unsigned char *) data, nbytes);
 
 		/*
@@ -250,6 +251,7 @@ dc_iostream_write (dc_iostream_t *iostream, const void *data, size_t size, size_
 		size_t nbytes = 0;
 
 		status = iostream->vtable->write (iostream, data, size, &nbytes);
+		TRACE (iostream->context, DC_TRACE_WRITE, iostream->transport, 0, status, (const unsigned char *) data, nbytes);
 		HEXDUMP (iostream->context, DC_LOGLEVEL_INFO, "Write", (const unsigned char *) data, nbytes);
 
 		if (actual) {
@@ -292,12 +294,14 @@ dc_iostream_ioctl (dc_iostream_t *iostream, unsigned int request, void *data, si
 		DC_IOCTL_NR(request), DC_IOCTL_SIZE(request));
 
 	if (DC_IOCTL_DIR(request) & DC_IOCTL_DIR_WRITE) {
+		TRACE (iostream->context, DC_TRACE_IOCTL_WRITE, iostream->transport, request, DC_STATUS_SUCCESS, (unsigned char *) data, size);
 		HEXDUMP (iostream->context, DC_LOGLEVEL_INFO, "Ioctl write", (unsigned char *) data, size);
 	}
 
 	status = iostream->vtable->ioctl (iostream, request, data, size);
 
 	if (DC_IOCTL_DIR(request) & DC_IOCTL_DIR_READ) {
+		TRACE (iostream->context, DC_TRACE_IOCTL_READ, iostream->transport, request, status, (unsigned char *) data, size);
 		HEXDUMP (iostream->context, DC_LOGLEVEL_INFO, "Ioctl read", (unsigned char *) data, size);
 	}
 
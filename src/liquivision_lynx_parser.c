@@ -117,6 +117,7 @@ struct liquivision_lynx_parser_t {
 };
 
 static dc_status_t liquivision_lynx_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t liquivision_lynx_parser_reset (dc_parser_t *abstract);
 static dc_status_t liquivision_lynx_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t liquivision_lynx_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t liquivision_lynx_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -125,9 +126,12 @@ static const dc_parser_vtable_t liquivision_lynx_parser_vtable = {
 	sizeof(liquivision_lynx_parser_t),
 	DC_FAMILY_LIQUIVISION_LYNX,
 	liquivision_lynx_parser_set_data, /* set_data */
+	liquivision_lynx_parser_reset, /* reset */
 	liquivision_lynx_parser_get_datetime, /* datetime */
 	liquivision_lynx_parser_get_field, /* fields */
+	NULL, /* summary */
 	liquivision_lynx_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -170,7 +174,7 @@ liquivision_lynx_parser_create (dc_parser_t **out, dc_context_t *context, unsign
 
 
 static dc_status_t
-liquivision_lynx_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+liquivision_lynx_parser_reset (dc_parser_t *abstract)
 {
 	liquivision_lynx_parser_t *parser = (liquivision_lynx_parser_t *) abstract;
 
@@ -191,6 +195,12 @@ liquivision_lynx_parser_set_data (dc_parser_t *abstract, const unsigned char *da
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+liquivision_lynx_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
 
 static dc_status_t
 liquivision_lynx_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
@@ -148,6 +148,7 @@ struct mares_iconhd_parser_t {
 };
 
 static dc_status_t mares_iconhd_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t mares_iconhd_parser_reset (dc_parser_t *abstract);
 static dc_status_t mares_iconhd_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t mares_iconhd_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t mares_iconhd_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -156,9 +157,12 @@ static const dc_parser_vtable_t mares_iconhd_parser_vtable = {
 	sizeof(mares_iconhd_parser_t),
 	DC_FAMILY_MARES_ICONHD,
 	mares_iconhd_parser_set_data, /* set_data */
+	mares_iconhd_parser_reset, /* reset */
 	mares_iconhd_parser_get_datetime, /* datetime */
 	mares_iconhd_parser_get_field, /* fields */
+	NULL, /* summary */
 	mares_iconhd_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -541,7 +545,7 @@ mares_iconhd_parser_create (dc_parser_t **out, dc_context_t *context, unsigned i
 
 
 static dc_status_t
-mares_iconhd_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+mares_iconhd_parser_reset (dc_parser_t *abstract)
 {
 	mares_iconhd_parser_t *parser = (mares_iconhd_parser_t *) abstract;
 
@@ -571,6 +575,12 @@ mares_iconhd_parser_set_data (dc_parser_t *abstract, const unsigned char *data,
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+mares_iconhd_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
 
 static dc_status_t
 mares_iconhd_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
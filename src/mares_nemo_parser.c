@@ -60,6 +60,7 @@ struct mares_nemo_parser_t {
 };
 
 static dc_status_t mares_nemo_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t mares_nemo_parser_reset (dc_parser_t *abstract);
 static dc_status_t mares_nemo_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t mares_nemo_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t mares_nemo_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -68,9 +69,12 @@ static const dc_parser_vtable_t mares_nemo_parser_vtable = {
 	sizeof(mares_nemo_parser_t),
 	DC_FAMILY_MARES_NEMO,
 	mares_nemo_parser_set_data, /* set_data */
+	mares_nemo_parser_reset, /* reset */
 	mares_nemo_parser_get_datetime, /* datetime */
 	mares_nemo_parser_get_field, /* fields */
+	NULL, /* summary */
 	mares_nemo_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -112,13 +116,11 @@ mares_nemo_parser_create (dc_parser_t **out, dc_context_t *context, unsigned int
 
 
 static dc_status_t
-mares_nemo_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+mares_nemo_parser_reset (dc_parser_t *abstract)
 {
 	mares_nemo_parser_t *parser = (mares_nemo_parser_t *) abstract;
 
 	// Clear the previous state.
-	parser->base.data = NULL;
-	parser->base.size = 0;
 	parser->mode = AIR;
 	parser->length = 0;
 	parser->sample_count = 0;
@@ -126,6 +128,18 @@ mares_nemo_parser_set_data (dc_parser_t *abstract, const unsigned char *data, un
 	parser->header = 0;
 	parser->extra = 0;
 
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+mares_nemo_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	mares_nemo_parser_t *parser = (mares_nemo_parser_t *) abstract;
+
+	// Clear the previous state.
+	parser->base.data = NULL;
+	parser->base.size = 0;
+
 	if (size == 0)
 		return DC_STATUS_SUCCESS;
 
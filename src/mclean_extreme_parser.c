@@ -57,6 +57,7 @@ struct mclean_extreme_parser_t {
 };
 
 static dc_status_t mclean_extreme_parser_set_data(dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t mclean_extreme_parser_reset(dc_parser_t *abstract);
 static dc_status_t mclean_extreme_parser_get_datetime(dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t mclean_extreme_parser_get_field(dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t mclean_extreme_parser_samples_foreach(dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -65,9 +66,12 @@ static const dc_parser_vtable_t mclean_extreme_parser_vtable = {
 	sizeof(mclean_extreme_parser_t),
 	DC_FAMILY_MCLEAN_EXTREME,
 	mclean_extreme_parser_set_data, /* set_data */
+	mclean_extreme_parser_reset, /* reset */
 	mclean_extreme_parser_get_datetime, /* datetime */
 	mclean_extreme_parser_get_field, /* fields */
+	NULL, /* summary */
 	mclean_extreme_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -100,7 +104,7 @@ mclean_extreme_parser_create(dc_parser_t **out, dc_context_t *context)
 }
 
 static dc_status_t
-mclean_extreme_parser_set_data(dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+mclean_extreme_parser_reset(dc_parser_t *abstract)
 {
 	mclean_extreme_parser_t *parser = (mclean_extreme_parser_t *)abstract;
 
@@ -114,6 +118,12 @@ mclean_extreme_parser_set_data(dc_parser_t *abstract, const unsigned char *data,
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+mclean_extreme_parser_set_data(dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
 static dc_status_t
 mclean_extreme_parser_get_datetime(dc_parser_t *abstract, dc_datetime_t *datetime)
 {
@@ -48,6 +48,9 @@
 #define MAXDELAY   16
 #define INVALID    0xFFFFFFFF
 
+#define CACHESIZE  4096
+#define CACHESLOTS 64
+
 #define CMD_INIT      0xA8
 #define CMD_VERSION   0x84
 #define CMD_HANDSHAKE 0xE5
@@ -62,6 +65,12 @@
 #define ACK 0x5A
 #define NAK 0xA5
 
+typedef struct oceanic_atom2_slot_t {
+	unsigned int page;
+	unsigned int highmem;
+	unsigned int stamp;
+} oceanic_atom2_slot_t;
+
 typedef struct oceanic_atom2_device_t {
 	oceanic_common_device_t base;
 	dc_iostream_t *iostream;
@@ -69,14 +78,20 @@ typedef struct oceanic_atom2_device_t {
 	unsigned int delay;
 	unsigned int extra;
 	unsigned int bigpage;
-	unsigned char cache[256];
-	unsigned int cached_page;
-	unsigned int cached_highmem;
+	// Read cache with the most recently used pages.
+	unsigned char cache[CACHESIZE];
+	oceanic_atom2_slot_t slots[CACHESLOTS];
+	unsigned int nslots;
+	unsigned int slotsize;
+	unsigned int stamp;
+	unsigned int hits;
+	unsigned int misses;
 } oceanic_atom2_device_t;
 
 static dc_status_t oceanic_atom2_device_read (dc_device_t *abstract, unsigned int address, unsigned char data[], unsigned int size);
 static dc_status_t oceanic_atom2_device_write (dc_device_t *abstract, unsigned int address, const unsigned char data[], unsigned int size);
 static dc_status_t oceanic_atom2_device_close (dc_device_t *abstract);
+static void oceanic_atom2_cache_invalidate (oceanic_atom2_device_t *device);
 
 static const oceanic_common_device_vtable_t oceanic_atom2_device_vtable = {
 	{
@@ -839,9 +854,13 @@ oceanic_atom2_device_open (dc_device_t **out, dc_context_t *context, dc_iostream
 	device->extra = model == PROPLUSX || model == I770R;
 	device->sequence = 0;
 	device->bigpage = 1; // no big pages
-	device->cached_page = INVALID;
-	device->cached_highmem = INVALID;
+	device->nslots = 0;
+	device->slotsize = 0;
+	device->stamp = 0;
+	device->hits = 0;
+	device->misses = 0;
 	memset(device->cache, 0, sizeof(device->cache));
+	oceanic_atom2_cache_invalidate (device);
 
 	// Get the correct baudrate.
 	unsigned int baudrate = 38400;
@@ -939,6 +958,13 @@ oceanic_atom2_device_open (dc_device_t **out, dc_context_t *context, dc_iostream
 		device->bigpage = 16;
 	}
 
+	// Size the read cache for the largest page of the memory layout. The
+	// high memory area is always read with big pages.
+	device->slotsize = device->base.layout->highmem ? 16 * PAGESIZE : device->bigpage * PAGESIZE;
+	device->nslots = CACHESIZE / device->slotsize;
+	if (device->nslots > CACHESLOTS)
+		device->nslots = CACHESLOTS;
+
 	*out = (dc_device_t*) device;
 
 	return DC_STATUS_SUCCESS;
@@ -956,6 +982,8 @@ oceanic_atom2_device_close (dc_device_t *abstract)
 	oceanic_atom2_device_t *device = (oceanic_atom2_device_t*) abstract;
 	dc_status_t rc = DC_STATUS_SUCCESS;
 
+	DEBUG (abstract->context, "Read cache: hits=%u, misses=%u", device->hits, device->misses);
+
 	// Send the quit command.
 	unsigned char command[4] = {CMD_QUIT, 0x05, 0xA5};
 	rc = oceanic_atom2_transfer (device, command, sizeof (command), NAK, NULL, 0, 0);
@@ -1005,6 +1033,70 @@ oceanic_atom2_device_version (dc_device_t *abstract, unsigned char data[], unsig
 }
 
 
+static void
+oceanic_atom2_cache_invalidate (oceanic_atom2_device_t *device)
+{
+	for (unsigned int i = 0; i < CACHESLOTS; ++i) {
+		device->slots[i].page = INVALID;
+		device->slots[i].highmem = INVALID;
+		device->slots[i].stamp = 0;
+	}
+}
+
+
+/*
+ * Get a page from the read cache, and download it into the least
+ * recently used slot if it is not cached yet.
+ */
+static dc_status_t
+oceanic_atom2_cache_get (oceanic_atom2_device_t *device, unsigned char read_cmd, unsigned int crc_size, unsigned int page, unsigned int highmem, unsigned int pagesize, const unsigned char **out)
+{
+	unsigned int slot = 0;
+
+	if (pagesize > device->slotsize)
+		return DC_STATUS_INVALIDARGS;
+
+	for (unsigned int i = 0; i < device->nslots; ++i) {
+		if (device->slots[i].page == page && device->slots[i].highmem == highmem) {
+			device->slots[i].stamp = ++device->stamp;
+			device->hits++;
+			*out = device->cache + i * device->slotsize;
+			return DC_STATUS_SUCCESS;
+		}
+
+		if (device->slots[i].stamp < device->slots[slot].stamp)
+			slot = i;
+	}
+
+	unsigned char *buffer = device->cache + slot * device->slotsize;
+
+	// Read the package.
+	unsigned int number = highmem ? page : page * device->bigpage; // This is always PAGESIZE, even in big page mode.
+	unsigned char command[] = {read_cmd,
+			(number >> 8) & 0xFF, // high
+			(number     ) & 0xFF, // low
+		};
+	dc_status_t rc = oceanic_atom2_transfer (device, command, sizeof (command), ACK, buffer, pagesize, crc_size);
+	if (rc != DC_STATUS_SUCCESS) {
+		// The slot contents are no longer valid.
+		device->slots[slot].page = INVALID;
+		device->slots[slot].highmem = INVALID;
+		device->slots[slot].stamp = 0;
+		return rc;
+	}
+
+	// Cache the page.
+	device->slots[slot].page = page;
+	device->slots[slot].highmem = highmem;
+	device->slots[slot].stamp = ++device->stamp;
+	device->misses++;
+
+	*out = buffer;
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 static dc_status_t
 oceanic_atom2_device_read (dc_device_t *abstract, unsigned int address, unsigned char data[], unsigned int size)
 {
@@ -1055,28 +1147,17 @@ oceanic_atom2_device_read (dc_device_t *abstract, unsigned int address, unsigned
 		// addresses back to their physical address.
 		unsigned int page = (address - highmem) / pagesize;
 
-		if (page != device->cached_page || highmem != device->cached_highmem) {
-			// Read the package.
-			unsigned int number = highmem ? page : page * device->bigpage; // This is always PAGESIZE, even in big page mode.
-			unsigned char command[] = {read_cmd,
-					(number >> 8) & 0xFF, // high
-					(number     ) & 0xFF, // low
-				};
-			dc_status_t rc = oceanic_atom2_transfer (device, command, sizeof (command), ACK, device->cache, pagesize, crc_size);
-			if (rc != DC_STATUS_SUCCESS)
-				return rc;
-
-			// Cache the page.
-			device->cached_page = page;
-			device->cached_highmem = highmem;
-		}
+		const unsigned char *cache = NULL;
+		dc_status_t rc = oceanic_atom2_cache_get (device, read_cmd, crc_size, page, highmem, pagesize, &cache);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
 
 		unsigned int offset = address % pagesize;
 		unsigned int length = pagesize - offset;
 		if (nbytes + length > size)
 			length = size - nbytes;
 
-		memcpy (data, device->cache + offset, length);
+		memcpy (data, cache + offset, length);
 
 		nbytes += length;
 		address += length;
@@ -1097,8 +1178,7 @@ oceanic_atom2_device_write (dc_device_t *abstract, unsigned int address, const u
 		return DC_STATUS_INVALIDARGS;
 
 	// Invalidate the cache.
-	device->cached_page = INVALID;
-	device->cached_highmem = INVALID;
+	oceanic_atom2_cache_invalidate (device);
 
 	unsigned int nbytes = 0;
 	while (nbytes < size) {
@@ -111,13 +111,77 @@
 #define HEADER  1
 #define PROFILE 2
 
+// Dive mode location
+#define DIVEMODE_NONE  0
+#define DIVEMODE_BYTE2 1 // Bits 6-7 of byte 2
+#define DIVEMODE_BYTE1 2 // Bits 5-6 of byte 1
+
+// Tank switch sample format
+#define TANK_1PSI      0 // Pressure (1 psi), no tank number
+#define TANK_1PSI_IDX  1 // Pressure (1 psi) and tank number
+#define TANK_2PSI_IDX  2 // Pressure (2 psi) at byte 4 and tank number
+#define TANK_2PSI_IDX3 3 // Pressure (2 psi) at byte 3 and tank number
+
+// Temperature sample format
+#define TEMPERATURE_BYTE   0 // Absolute value (single byte)
+#define TEMPERATURE_PACKED 1 // Absolute value (bits spread over bytes 5 and 7)
+#define TEMPERATURE_DELTA  2 // Relative to the previous sample
+
+// Temperature sign bit of the relative format
+#define SIGN_BYTE5_INV 0
+#define SIGN_BYTE5     1
+#define SIGN_BYTE0     2
+#define SIGN_BYTE0_INV 3
+
+// Tank pressure sample format
+#define PRESSURE_NONE   0
+#define PRESSURE_BYTE10 1 // Absolute value (1 psi)
+#define PRESSURE_BYTE0  2 // Absolute value (5 psi)
+#define PRESSURE_BYTE4  3 // Absolute value (1 psi)
+#define PRESSURE_DELTA  4 // Relative to the previous sample
+
+typedef struct oceanic_atom2_parser_layout_t {
+	unsigned int headersize;
+	unsigned int footersize;
+	unsigned int header; // Offset of the header sample
+	unsigned int freedive; // Dedicated freedive computer
+	unsigned int datetime; // Minimum size for the date/time
+	unsigned int divemode;
+	// Gas mixes
+	unsigned int ngasmixes; // Zero if stored in the header
+	unsigned int o2_offset;
+	unsigned int o2_step;
+	unsigned int he_offset;
+	// Header fields
+	unsigned int interval; // Offset of the sample interval
+	unsigned int samplerate; // Offset of the sample rate (freedive)
+	unsigned int pressure; // Offset of the initial tank pressure
+	unsigned int salinity;
+	// Samples
+	unsigned int samplesize;
+	unsigned int samplesize_freedive;
+	unsigned int timestamp; // Samples contain a BCD timestamp
+	unsigned int tank;
+	unsigned int temperature;
+	unsigned int temperature_offset;
+	unsigned int temperature_sign;
+	unsigned int pressure_type;
+	unsigned int depth_offset, depth_mask, depth_shift;
+	unsigned int gasmix_mask;
+	unsigned int deco;
+	unsigned int decostop_offset, decostop_mask, decostop_shift;
+	unsigned int decotime_offset, decotime_mask;
+	unsigned int rbt;
+	unsigned int rbt_offset, rbt_mask;
+	unsigned int bookmark;
+} oceanic_atom2_parser_layout_t;
+
 typedef struct oceanic_atom2_parser_t oceanic_atom2_parser_t;
 
 struct oceanic_atom2_parser_t {
 	dc_parser_t base;
 	unsigned int model;
-	unsigned int headersize;
-	unsigned int footersize;
+	oceanic_atom2_parser_layout_t layout;
 	unsigned int serial;
 	// Cached fields.
 	unsigned int cached;
@@ -132,40 +196,34 @@ struct oceanic_atom2_parser_t {
 };
 
 static dc_status_t oceanic_atom2_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t oceanic_atom2_parser_reset (dc_parser_t *abstract);
 static dc_status_t oceanic_atom2_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t oceanic_atom2_parser_samples (oceanic_atom2_parser_t *parser, unsigned int mask, dc_sample_callback_t callback, void *userdata);
 
 static const dc_parser_vtable_t oceanic_atom2_parser_vtable = {
 	sizeof(oceanic_atom2_parser_t),
 	DC_FAMILY_OCEANIC_ATOM2,
 	oceanic_atom2_parser_set_data, /* set_data */
+	oceanic_atom2_parser_reset, /* reset */
 	oceanic_atom2_parser_get_datetime, /* datetime */
 	oceanic_atom2_parser_get_field, /* fields */
+	NULL, /* summary */
 	oceanic_atom2_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
 
-dc_status_t
-oceanic_atom2_parser_create (dc_parser_t **out, dc_context_t *context, unsigned int model, unsigned int serial)
+static void
+oceanic_atom2_parser_layout (oceanic_atom2_parser_layout_t *layout, unsigned int model)
 {
-	oceanic_atom2_parser_t *parser = NULL;
-
-	if (out == NULL)
-		return DC_STATUS_INVALIDARGS;
-
-	// Allocate memory.
-	parser = (oceanic_atom2_parser_t *) dc_parser_allocate (context, &oceanic_atom2_parser_vtable);
-	if (parser == NULL) {
-		ERROR (context, "Failed to allocate memory.");
-		return DC_STATUS_NOMEMORY;
-	}
+	memset (layout, 0, sizeof (*layout));
 
-	// Set the default values.
-	parser->model = model;
-	parser->headersize = 9 * PAGESIZE / 2;
-	parser->footersize = 2 * PAGESIZE / 2;
+	// Get the total amount of bytes before and after the profile data.
+	layout->headersize = 9 * PAGESIZE / 2;
+	layout->footersize = 2 * PAGESIZE / 2;
 	if (model == DATAMASK || model == COMPUMASK ||
 		model == GEO || model == GEO20 ||
 		model == VEO20 || model == VEO30 ||
@@ -176,32 +234,358 @@ oceanic_atom2_parser_create (dc_parser_t **out, dc_context_t *context, unsigned
 		model == I200 || model == I200C ||
 		model == I300C || model == GEO40 ||
 		model == VEO40 || model == I470TC) {
-		parser->headersize -= PAGESIZE;
+		layout->headersize -= PAGESIZE;
 	} else if (model == VT4 || model == VT41) {
-		parser->headersize += PAGESIZE;
+		layout->headersize += PAGESIZE;
 	} else if (model == TX1) {
-		parser->headersize += 2 * PAGESIZE;
+		layout->headersize += 2 * PAGESIZE;
 	} else if (model == ATOM1 || model == I100 ||
 		model == PROPLUS4) {
-		parser->headersize -= 2 * PAGESIZE;
+		layout->headersize -= 2 * PAGESIZE;
 	} else if (model == F10A || model == F10B ||
 		model == MUNDIAL2 || model == MUNDIAL3) {
-		parser->headersize = 3 * PAGESIZE;
-		parser->footersize = 0;
+		layout->headersize = 3 * PAGESIZE;
+		layout->footersize = 0;
 	} else if (model == F11A || model == F11B) {
-		parser->headersize = 5 * PAGESIZE;
-		parser->footersize = 0;
+		layout->headersize = 5 * PAGESIZE;
+		layout->footersize = 0;
 	} else if (model == A300CS || model == VTX ||
 		model == I450T || model == I750TC ||
 		model == I770R || model == SAGE ||
 		model == BEACON) {
-		parser->headersize = 5 * PAGESIZE;
+		layout->headersize = 5 * PAGESIZE;
 	} else if (model == PROPLUSX) {
-		parser->headersize = 3 * PAGESIZE;
+		layout->headersize = 3 * PAGESIZE;
 	} else if (model == I550C || model == WISDOM4) {
-		parser->headersize = 5 * PAGESIZE / 2;
+		layout->headersize = 5 * PAGESIZE / 2;
+	}
+
+	// Get the offset to the header sample.
+	layout->header = layout->headersize - PAGESIZE / 2;
+	if (model == VT4 || model == VT41 ||
+		model == A300AI || model == VISION ||
+		model == XPAIR) {
+		layout->header = 3 * PAGESIZE;
+	}
+
+	// Get the dive mode.
+	layout->datetime = 8;
+	if (model == F10A || model == F10B ||
+		model == F11A || model == F11B ||
+		model == MUNDIAL2 || model == MUNDIAL3) {
+		layout->freedive = 1;
+		layout->datetime = 32;
+	} else if (model == T3B || model == VT3 ||
+		model == DG03) {
+		layout->divemode = DIVEMODE_BYTE2;
+	} else if (model == VEO20 || model == VEO30 ||
+		model == OCS) {
+		layout->divemode = DIVEMODE_BYTE1;
+	}
+
+	// Get the gas mixes.
+	layout->o2_step = 1;
+	if (model == DATAMASK || model == COMPUMASK) {
+		layout->ngasmixes = 1;
+		layout->o2_offset = layout->header + 3;
+	} else if (model == VT4 || model == VT41 ||
+		model == A300AI || model == VISION ||
+		model == XPAIR) {
+		layout->o2_offset = layout->header + 4;
+		layout->ngasmixes = 4;
+	} else if (model == OCI) {
+		layout->o2_offset = 0x28;
+		layout->ngasmixes = 4;
+	} else if (model == TX1) {
+		layout->o2_offset = 0x3E;
+		layout->he_offset = 0x48;
+		layout->ngasmixes = 6;
+	} else if (model == A300CS || model == VTX ||
+		model == I750TC || model == SAGE ||
+		model == BEACON) {
+		layout->o2_offset = 0x2A;
+		layout->ngasmixes = 0;
+	} else if (model == I450T) {
+		layout->o2_offset = 0x30;
+		layout->ngasmixes = 3;
+	} else if (model == ZEN) {
+		layout->o2_offset = layout->header + 4;
+		layout->ngasmixes = 2;
+	} else if (model == PROPLUSX) {
+		layout->o2_offset = 0x24;
+		layout->ngasmixes = 4;
+	} else if (model == I770R) {
+		layout->o2_offset = 0x30;
+		layout->ngasmixes = 4;
+		layout->o2_step = 2;
+	} else if (model == I470TC) {
+		layout->o2_offset = 0x28;
+		layout->ngasmixes = 3;
+		layout->o2_step = 2;
+	} else if (model == WISDOM4) {
+		layout->o2_offset = layout->header + 4;
+		layout->ngasmixes = 1;
+	} else {
+		layout->o2_offset = layout->header + 4;
+		layout->ngasmixes = 3;
+	}
+
+	// Get the sample interval.
+	layout->interval = 0x17;
+	if (model == A300CS || model == VTX ||
+		model == I450T || model == I750TC ||
+		model == PROPLUSX || model == I770R ||
+		model == SAGE || model == BEACON)
+		layout->interval = 0x1f;
+	if (model == F11A || model == F11B)
+		layout->samplerate = 0x29;
+
+	// Get the salinity.
+	if (model == A300CS || model == VTX ||
+		model == I750TC || model == I770R)
+		layout->salinity = 1;
+
+	// Get the sample size.
+	layout->samplesize = PAGESIZE / 2;
+	if (model == OC1A || model == OC1B ||
+		model == OC1C || model == OCI ||
+		model == TX1 || model == A300CS ||
+		model == VTX || model == I450T ||
+		model == I750TC || model == PROPLUSX ||
+		model == I770R || model == I470TC ||
+		model == SAGE || model == BEACON) {
+		layout->samplesize = PAGESIZE;
+	}
+	if (layout->freedive) {
+		layout->samplesize_freedive = 2;
+	} else {
+		layout->samplesize_freedive = 4;
+	}
+
+	// Time
+	if (model == I450T || model == I470TC)
+		layout->timestamp = 1;
+
+	// Tank switch
+	if (model == DATAMASK || model == COMPUMASK) {
+		layout->tank = TANK_1PSI;
+	} else if (model == A300CS || model == VTX ||
+		model == I750TC || model == I770R ||
+		model == SAGE || model == BEACON) {
+		layout->tank = TANK_1PSI_IDX;
+	} else if (model == ATOM2 || model == EPICA || model == EPICB) {
+		layout->tank = TANK_2PSI_IDX3;
+	} else {
+		layout->tank = TANK_2PSI_IDX;
+	}
+
+	// Temperature (°F)
+	if (model == GEO || model == ATOM1 ||
+		model == ELEMENT2 || model == MANTA ||
+		model == ZEN) {
+		layout->temperature = TEMPERATURE_BYTE;
+		layout->temperature_offset = 6;
+	} else if (model == TALIS) {
+		layout->temperature = TEMPERATURE_BYTE;
+		layout->temperature_offset = 7;
+	} else if (model == GEO20 || model == VEO20 ||
+		model == VEO30 || model == OC1A ||
+		model == OC1B || model == OC1C ||
+		model == OCI || model == A300 ||
+		model == I450T || model == I300 ||
+		model == I200 || model == I100 ||
+		model == I300C || model == I200C ||
+		model == GEO40 || model == VEO40 ||
+		model == I470TC) {
+		layout->temperature = TEMPERATURE_BYTE;
+		layout->temperature_offset = 3;
+	} else if (model == OCS || model == TX1) {
+		layout->temperature = TEMPERATURE_BYTE;
+		layout->temperature_offset = 1;
+	} else if (model == VT4 || model == VT41 ||
+		model == ATOM3 || model == ATOM31 ||
+		model == A300AI || model == VISION ||
+		model == XPAIR) {
+		layout->temperature = TEMPERATURE_PACKED;
+	} else if (model == A300CS || model == VTX ||
+		model == I750TC || model == PROPLUSX ||
+		model == I770R|| model == SAGE ||
+		model == BEACON) {
+		layout->temperature = TEMPERATURE_BYTE;
+		layout->temperature_offset = 11;
+	} else {
+		layout->temperature = TEMPERATURE_DELTA;
+		if (model == DG03 || model == PROPLUS3 ||
+			model == I550 || model == I550C ||
+			model == PROPLUS4 || model == WISDOM4)
+			layout->temperature_sign = SIGN_BYTE5_INV;
+		else if (model == VOYAGER2G || model == AMPHOS ||
+			model == AMPHOSAIR || model == ZENAIR)
+			layout->temperature_sign = SIGN_BYTE5;
+		else if (model == ATOM2 || model == PROPLUS21 ||
+			model == EPICA || model == EPICB ||
+			model == ATMOSAI2 ||
+			model == WISDOM2 || model == WISDOM3)
+			layout->temperature_sign = SIGN_BYTE0;
+		else
+			layout->temperature_sign = SIGN_BYTE0_INV;
+	}
+
+	// Tank Pressure (psi)
+	layout->pressure = 2;
+	if (model == A300CS || model == VTX ||
+		model == I750TC || model == I770R)
+		layout->pressure = 16;
+	if (model == VEO30 || model == OCS ||
+		model == ELEMENT2 || model == VEO20 ||
+		model == A300 || model == ZEN ||
+		model == GEO || model == GEO20 ||
+		model == MANTA || model == I300 ||
+		model == I200 || model == I100 ||
+		model == I300C || model == TALIS ||
+		model == I200C || model == GEO40 ||
+		model == VEO40)
+		layout->pressure_type = PRESSURE_NONE;
+	else if (model == OC1A || model == OC1B ||
+		model == OC1C || model == OCI ||
+		model == I450T || model == I470TC)
+		layout->pressure_type = PRESSURE_BYTE10;
+	else if (model == VT4 || model == VT41||
+		model == ATOM3 || model == ATOM31 ||
+		model == ZENAIR ||model == A300AI ||
+		model == DG03 || model == PROPLUS3 ||
+		model == AMPHOSAIR || model == I550 ||
+		model == VISION || model == XPAIR ||
+		model == I550C || model == PROPLUS4 ||
+		model == WISDOM4)
+		layout->pressure_type = PRESSURE_BYTE0;
+	else if (model == TX1 || model == A300CS ||
+		model == VTX || model == I750TC ||
+		model == PROPLUSX || model == I770R ||
+		model == SAGE || model == BEACON)
+		layout->pressure_type = PRESSURE_BYTE4;
+	else
+		layout->pressure_type = PRESSURE_DELTA;
+
+	// Depth (1/16 ft)
+	if (model == GEO20 || model == VEO20 ||
+		model == VEO30 || model == OC1A ||
+		model == OC1B || model == OC1C ||
+		model == OCI || model == A300 ||
+		model == I450T || model == I300 ||
+		model == I200 || model == I100 ||
+		model == I300C || model == I200C ||
+		model == GEO40 || model == VEO40 ||
+		model == I470TC) {
+		layout->depth_offset = 4;
+		layout->depth_mask = 0x0FFF;
+	} else if (model == ATOM1) {
+		layout->depth_offset = 3;
+		layout->depth_mask = 0x00FF;
+		layout->depth_shift = 4;
+	} else {
+		layout->depth_offset = 2;
+		layout->depth_mask = 0x0FFF;
+	}
+
+	// Gas mix
+	if (model == TX1) {
+		layout->gasmix_mask = 0x07;
+	}
+
+	// NDL / Deco
+	layout->deco = 1;
+	if (model == A300CS || model == VTX ||
+		model == I750TC || model == SAGE ||
+		model == PROPLUSX || model == I770R ||
+		model == BEACON) {
+		layout->decostop_offset = 15;
+		layout->decostop_mask = 0x70;
+		layout->decostop_shift = 4;
+		layout->decotime_offset = 6;
+		layout->decotime_mask = 0x03FF;
+	} else if (model == ZEN || model == DG03) {
+		layout->decostop_offset = 5;
+		layout->decostop_mask = 0xF0;
+		layout->decostop_shift = 4;
+		layout->decotime_offset = 4;
+		layout->decotime_mask = 0x0FFF;
+	} else if (model == TX1) {
+		layout->decostop_offset = 10;
+		layout->decostop_mask = 0xFF;
+		layout->decostop_shift = 0;
+		layout->decotime_offset = 6;
+		layout->decotime_mask = 0xFFFF;
+	} else if (model == ATOM31 || model == VISION ||
+		model == XPAIR || model == I550 ||
+		model == I550C || model == WISDOM4) {
+		layout->decostop_offset = 5;
+		layout->decostop_mask = 0xF0;
+		layout->decostop_shift = 4;
+		layout->decotime_offset = 4;
+		layout->decotime_mask = 0x03FF;
+	} else if (model == I200 || model == I300 ||
+		model == OC1A || model == OC1B ||
+		model == OC1C || model == OCI ||
+		model == I100 || model == I300C ||
+		model == I450T || model == I200C ||
+		model == GEO40 || model == VEO40 ||
+		model == I470TC) {
+		layout->decostop_offset = 7;
+		layout->decostop_mask = 0xF0;
+		layout->decostop_shift = 4;
+		layout->decotime_offset = 6;
+		layout->decotime_mask = 0x0FFF;
+	} else {
+		layout->deco = 0;
+	}
+
+	// Remaining bottom time
+	layout->rbt = 1;
+	if (model == ATOM31) {
+		layout->rbt_offset = 6;
+		layout->rbt_mask = 0x01FF;
+	} else if (model == I450T || model == OC1A ||
+		model == OC1B || model == OC1C ||
+		model == OCI || model == PROPLUSX ||
+		model == I770R || model == I470TC) {
+		layout->rbt_offset = 8;
+		layout->rbt_mask = 0x01FF;
+	} else if (model == VISION || model == XPAIR ||
+		model == I550 || model == I550C ||
+		model == WISDOM4) {
+		layout->rbt_offset = 6;
+		layout->rbt_mask = 0x03FF;
+	} else {
+		layout->rbt = 0;
+	}
+
+	// Bookmarks
+	if (model == OC1A || model == OC1B ||
+		model == OC1C || model == OCI) {
+		layout->bookmark = 1;
+	}
+}
+
+
+dc_status_t
+oceanic_atom2_parser_create (dc_parser_t **out, dc_context_t *context, unsigned int model, unsigned int serial)
+{
+	oceanic_atom2_parser_t *parser = NULL;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	// Allocate memory.
+	parser = (oceanic_atom2_parser_t *) dc_parser_allocate (context, &oceanic_atom2_parser_vtable);
+	if (parser == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
 	}
 
+	// Set the default values.
+	parser->model = model;
+	oceanic_atom2_parser_layout (&parser->layout, model);
 	parser->serial = serial;
 	parser->cached = 0;
 	parser->header = 0;
@@ -222,7 +606,7 @@ oceanic_atom2_parser_create (dc_parser_t **out, dc_context_t *context, unsigned
 
 
 static dc_status_t
-oceanic_atom2_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+oceanic_atom2_parser_reset (dc_parser_t *abstract)
 {
 	oceanic_atom2_parser_t *parser = (oceanic_atom2_parser_t *) abstract;
 
@@ -242,19 +626,19 @@ oceanic_atom2_parser_set_data (dc_parser_t *abstract, const unsigned char *data,
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+oceanic_atom2_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
 
 static dc_status_t
 oceanic_atom2_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
 {
 	oceanic_atom2_parser_t *parser = (oceanic_atom2_parser_t *) abstract;
 
-	unsigned int header = 8;
-	if (parser->model == F10A || parser->model == F10B ||
-		parser->model == F11A || parser->model == F11B ||
-		parser->model == MUNDIAL2 || parser->model == MUNDIAL3)
-		header = 32;
-
-	if (abstract->size < header)
+	if (abstract->size < parser->layout.datetime)
 		return DC_STATUS_DATAFORMAT;
 
 	const unsigned char *p = abstract->data;
@@ -419,61 +803,36 @@ oceanic_atom2_parser_cache (oceanic_atom2_parser_t *parser)
 		return DC_STATUS_SUCCESS;
 	}
 
+	const oceanic_atom2_parser_layout_t *layout = &parser->layout;
+
 	// Get the total amount of bytes before and after the profile data.
-	unsigned int headersize = parser->headersize;
-	unsigned int footersize = parser->footersize;
+	unsigned int headersize = layout->headersize;
+	unsigned int footersize = layout->footersize;
 	if (size < headersize + footersize)
 		return DC_STATUS_DATAFORMAT;
 
 	// Get the offset to the header and footer sample.
-	unsigned int header = headersize - PAGESIZE / 2;
+	unsigned int header = layout->header;
 	unsigned int footer = size - footersize;
-	if (parser->model == VT4 || parser->model == VT41 ||
-		parser->model == A300AI || parser->model == VISION ||
-		parser->model == XPAIR) {
-		header = 3 * PAGESIZE;
-	}
 
 	// Get the dive mode.
 	unsigned int mode = NORMAL;
-	if (parser->model == F10A || parser->model == F10B ||
-		parser->model == F11A || parser->model == F11B ||
-		parser->model == MUNDIAL2 || parser->model == MUNDIAL3) {
+	if (layout->freedive) {
 		mode = FREEDIVE;
-	} else if (parser->model == T3B || parser->model == VT3 ||
-		parser->model == DG03) {
+	} else if (layout->divemode == DIVEMODE_BYTE2) {
 		mode = (data[2] & 0xC0) >> 6;
-	} else if (parser->model == VEO20 || parser->model == VEO30 ||
-		parser->model == OCS) {
+	} else if (layout->divemode == DIVEMODE_BYTE1) {
 		mode = (data[1] & 0x60) >> 5;
 	}
 
 	// Get the gas mixes.
-	unsigned int ngasmixes = 0;
-	unsigned int o2_offset = 0;
-	unsigned int he_offset = 0;
-	unsigned int o2_step = 1;
+	unsigned int ngasmixes = layout->ngasmixes;
+	unsigned int o2_offset = layout->o2_offset;
+	unsigned int he_offset = layout->he_offset;
+	unsigned int o2_step = layout->o2_step;
 	if (mode == FREEDIVE) {
 		ngasmixes = 0;
-	} else if (parser->model == DATAMASK || parser->model == COMPUMASK) {
-		ngasmixes = 1;
-		o2_offset = header + 3;
-	} else if (parser->model == VT4 || parser->model == VT41 ||
-		parser->model == A300AI || parser->model == VISION ||
-		parser->model == XPAIR) {
-		o2_offset = header + 4;
-		ngasmixes = 4;
-	} else if (parser->model == OCI) {
-		o2_offset = 0x28;
-		ngasmixes = 4;
-	} else if (parser->model == TX1) {
-		o2_offset = 0x3E;
-		he_offset = 0x48;
-		ngasmixes = 6;
-	} else if (parser->model == A300CS || parser->model == VTX ||
-		parser->model == I750TC || parser->model == SAGE ||
-		parser->model == BEACON) {
-		o2_offset = 0x2A;
+	} else if (ngasmixes == 0) {
 		if (data[0x39] & 0x04) {
 			ngasmixes = 1;
 		} else if (data[0x39] & 0x08) {
@@ -483,29 +842,6 @@ oceanic_atom2_parser_cache (oceanic_atom2_parser_t *parser)
 		} else {
 			ngasmixes = 4;
 		}
-	} else if (parser->model == I450T) {
-		o2_offset = 0x30;
-		ngasmixes = 3;
-	} else if (parser->model == ZEN) {
-		o2_offset = header + 4;
-		ngasmixes = 2;
-	} else if (parser->model == PROPLUSX) {
-		o2_offset = 0x24;
-		ngasmixes = 4;
-	} else if (parser->model == I770R) {
-		o2_offset = 0x30;
-		ngasmixes = 4;
-		o2_step = 2;
-	} else if (parser->model == I470TC) {
-		o2_offset = 0x28;
-		ngasmixes = 3;
-		o2_step = 2;
-	} else if (parser->model == WISDOM4) {
-		o2_offset = header + 4;
-		ngasmixes = 1;
-	} else {
-		o2_offset = header + 4;
-		ngasmixes = 3;
 	}
 
 	// Cache the data for later use.
@@ -545,15 +881,9 @@ oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 
 	// Cache the profile data.
 	if (parser->cached < PROFILE) {
-		sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
-		status = oceanic_atom2_parser_samples_foreach (
-			abstract, sample_statistics_cb, &statistics);
+		status = oceanic_atom2_parser_samples (parser, DC_SAMPLE_MASK_STATISTICS, NULL, NULL);
 		if (status != DC_STATUS_SUCCESS)
 			return status;
-
-		parser->cached = PROFILE;
-		parser->divetime = statistics.divetime;
-		parser->maxdepth = statistics.maxdepth;
 	}
 
 	dc_gasmix_t *gasmix = (dc_gasmix_t *) value;
@@ -565,17 +895,13 @@ oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 	if (value) {
 		switch (type) {
 		case DC_FIELD_DIVETIME:
-			if (parser->model == F10A || parser->model == F10B ||
-				parser->model == F11A || parser->model == F11B ||
-				parser->model == MUNDIAL2 || parser->model == MUNDIAL3)
+			if (parser->layout.freedive)
 				*((unsigned int *) value) = bcd2dec (data[2]) + bcd2dec (data[3]) * 60;
 			else
 				*((unsigned int *) value) = parser->divetime;
 			break;
 		case DC_FIELD_MAXDEPTH:
-			if (parser->model == F10A || parser->model == F10B ||
-				parser->model == F11A || parser->model == F11B ||
-				parser->model == MUNDIAL2 || parser->model == MUNDIAL3)
+			if (parser->layout.freedive)
 				*((double *) value) = array_uint16_le (data + 4) / 16.0 * FEET;
 			else
 				*((double *) value) = (array_uint16_le (data + parser->footer + 4) & 0x0FFF) / 16.0 * FEET;
@@ -589,8 +915,7 @@ oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 			gasmix->nitrogen = 1.0 - gasmix->oxygen - gasmix->helium;
 			break;
 		case DC_FIELD_SALINITY:
-			if (parser->model == A300CS || parser->model == VTX ||
-				parser->model == I750TC || parser->model == I770R) {
+			if (parser->layout.salinity) {
 				if (data[0x18] & 0x80) {
 					water->type = DC_WATER_FRESH;
 				} else {
@@ -671,11 +996,17 @@ oceanic_atom2_parser_vendor (oceanic_atom2_parser_t *parser, const unsigned char
 	}
 }
 
+/*
+ * Walk the profile data. The dive time and maximum depth are collected on
+ * the fly, so the profile statistics come for free with the first walk.
+ * Sample types that are not in the mask are not decoded.
+ */
 static dc_status_t
-oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
+oceanic_atom2_parser_samples (oceanic_atom2_parser_t *parser, unsigned int mask, dc_sample_callback_t callback, void *userdata)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
-	oceanic_atom2_parser_t *parser = (oceanic_atom2_parser_t *) abstract;
+	dc_parser_t *abstract = (dc_parser_t *) parser;
+	sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
 
 	const unsigned char *data = abstract->data;
 	unsigned int size = abstract->size;
@@ -685,18 +1016,14 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 	if (status != DC_STATUS_SUCCESS)
 		return status;
 
+	const oceanic_atom2_parser_layout_t *layout = &parser->layout;
+
 	unsigned int extratime = 0;
 	unsigned int time = 0;
 	unsigned int interval = 1;
 	unsigned int samplerate = 1;
 	if (parser->mode != FREEDIVE) {
-		unsigned int idx = 0x17;
-		if (parser->model == A300CS || parser->model == VTX ||
-			parser->model == I450T || parser->model == I750TC ||
-			parser->model == PROPLUSX || parser->model == I770R ||
-			parser->model == SAGE || parser->model == BEACON)
-			idx = 0x1f;
-		switch (data[idx] & 0x03) {
+		switch (data[layout->interval] & 0x03) {
 		case 0:
 			interval = 2;
 			break;
@@ -710,9 +1037,8 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 			interval = 60;
 			break;
 		}
-	} else if (parser->model == F11A || parser->model == F11B) {
-		unsigned int idx = 0x29;
-		switch (data[idx] & 0x03) {
+	} else if (layout->samplerate) {
+		switch (data[layout->samplerate] & 0x03) {
 		case 0:
 			interval = 1;
 			samplerate = 4;
@@ -736,39 +1062,24 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 		}
 	}
 
-	unsigned int samplesize = PAGESIZE / 2;
-	if (parser->mode == FREEDIVE) {
-		if (parser->model == F10A || parser->model == F10B ||
-			parser->model == F11A || parser->model == F11B ||
-			parser->model == MUNDIAL2 || parser->model == MUNDIAL3) {
-			samplesize = 2;
-		} else {
-			samplesize = 4;
-		}
-	} else if (parser->model == OC1A || parser->model == OC1B ||
-		parser->model == OC1C || parser->model == OCI ||
-		parser->model == TX1 || parser->model == A300CS ||
-		parser->model == VTX || parser->model == I450T ||
-		parser->model == I750TC || parser->model == PROPLUSX ||
-		parser->model == I770R || parser->model == I470TC ||
-		parser->model == SAGE || parser->model == BEACON) {
-		samplesize = PAGESIZE;
+	// Resolve the sample format for this dive. The freedive mode has its
+	// own, much simpler, format.
+	unsigned int samplesize = layout->samplesize;
+	unsigned int have_temperature = DC_SAMPLE_WANTED(mask, DC_SAMPLE_TEMPERATURE);
+	unsigned int pressure_type = layout->pressure_type;
+	unsigned int depth_offset = layout->depth_offset;
+	unsigned int depth_mask = layout->depth_mask;
+	unsigned int depth_shift = layout->depth_shift;
+	if (!DC_SAMPLE_WANTED(mask, DC_SAMPLE_PRESSURE)) {
+		pressure_type = PRESSURE_NONE;
 	}
-
-	unsigned int have_temperature = 1, have_pressure = 1;
 	if (parser->mode == FREEDIVE) {
+		samplesize = layout->samplesize_freedive;
 		have_temperature = 0;
-		have_pressure = 0;
-	} else if (parser->model == VEO30 || parser->model == OCS ||
-		parser->model == ELEMENT2 || parser->model == VEO20 ||
-		parser->model == A300 || parser->model == ZEN ||
-		parser->model == GEO || parser->model == GEO20 ||
-		parser->model == MANTA || parser->model == I300 ||
-		parser->model == I200 || parser->model == I100 ||
-		parser->model == I300C || parser->model == TALIS ||
-		parser->model == I200C || parser->model == GEO40 ||
-		parser->model == VEO40) {
-		have_pressure = 0;
+		pressure_type = PRESSURE_NONE;
+		depth_offset = 0;
+		depth_mask = 0xFFFF;
+		depth_shift = 0;
 	}
 
 	// Initial temperature.
@@ -780,14 +1091,10 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 	// Initial tank pressure.
 	unsigned int tank = 0;
 	unsigned int pressure = 0;
-	if (have_pressure) {
-		unsigned int idx = 2;
-		if (parser->model == A300CS || parser->model == VTX ||
-			parser->model == I750TC || parser->model == I770R)
-			idx = 16;
-		pressure = array_uint16_le(data + parser->header + idx);
+	if (pressure_type != PRESSURE_NONE) {
+		pressure = array_uint16_le(data + parser->header + layout->pressure);
 		if (pressure == 10000)
-			have_pressure = 0;
+			pressure_type = PRESSURE_NONE;
 	}
 
 	// Initial gas mix.
@@ -796,14 +1103,16 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 	unsigned int count = 0;
 	unsigned int complete = 1;
 	unsigned int previous = 0;
-	unsigned int offset = parser->headersize;
-	while (offset + samplesize <= size - parser->footersize) {
+	unsigned int offset = layout->headersize;
+	unsigned int end = size - layout->footersize;
+	while (offset + samplesize <= end) {
 		dc_sample_value_t sample = {0};
+		const unsigned char *p = data + offset;
 
 		// Ignore empty samples.
 		if ((parser->mode != FREEDIVE &&
-			array_isequal (data + offset, samplesize, 0x00)) ||
-			array_isequal (data + offset, samplesize, 0xFF)) {
+			array_isequal (p, samplesize, 0x00)) ||
+			array_isequal (p, samplesize, 0xFF)) {
 			offset += samplesize;
 			continue;
 		}
@@ -814,7 +1123,7 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 		}
 
 		// Get the sample type.
-		unsigned int sampletype = data[offset + 0];
+		unsigned int sampletype = p[0];
 		if (parser->mode == FREEDIVE)
 			sampletype = 0;
 
@@ -823,7 +1132,7 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 		unsigned int length = samplesize;
 		if (sampletype == 0xBB) {
 			length = PAGESIZE;
-			if (offset + length > size - parser->footersize) {
+			if (offset + length > end) {
 				ERROR (abstract->context, "Buffer overflow detected!");
 				return DC_STATUS_DATAFORMAT;
 			}
@@ -831,39 +1140,44 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 
 		// Check for a tank switch sample.
 		if (sampletype == 0xAA) {
-			if (parser->model == DATAMASK || parser->model == COMPUMASK) {
+			switch (layout->tank) {
+			case TANK_1PSI:
 				// Tank pressure (1 psi) and number
 				tank = 0;
-				pressure = (((data[offset + 7] << 8) + data[offset + 6]) & 0x0FFF);
-			} else if (parser->model == A300CS || parser->model == VTX ||
-				parser->model == I750TC || parser->model == I770R ||
-				parser->model == SAGE || parser->model == BEACON) {
+				pressure = (((p[7] << 8) + p[6]) & 0x0FFF);
+				break;
+			case TANK_1PSI_IDX:
 				// Tank pressure (1 psi) and number (one based index)
-				tank = (data[offset + 1] & 0x03) - 1;
-				pressure = ((data[offset + 7] << 8) + data[offset + 6]) & 0x0FFF;
-			} else {
+				tank = (p[1] & 0x03) - 1;
+				pressure = ((p[7] << 8) + p[6]) & 0x0FFF;
+				break;
+			case TANK_2PSI_IDX3:
 				// Tank pressure (2 psi) and number (one based index)
-				tank = (data[offset + 1] & 0x03) - 1;
-				if (parser->model == ATOM2 || parser->model == EPICA || parser->model == EPICB)
-					pressure = (((data[offset + 3] << 8) + data[offset + 4]) & 0x0FFF) * 2;
-				else
-					pressure = (((data[offset + 4] << 8) + data[offset + 5]) & 0x0FFF) * 2;
+				tank = (p[1] & 0x03) - 1;
+				pressure = (((p[3] << 8) + p[4]) & 0x0FFF) * 2;
+				break;
+			default:
+				// Tank pressure (2 psi) and number (one based index)
+				tank = (p[1] & 0x03) - 1;
+				pressure = (((p[4] << 8) + p[5]) & 0x0FFF) * 2;
+				break;
 			}
 		} else if (sampletype == 0xBB) {
 			// The surface time is not always a nice multiple of the samplerate.
 			// The number of inserted surface samples is therefore rounded down
 			// to keep the timestamps aligned at multiples of the samplerate.
-			unsigned int surftime = 60 * bcd2dec (data[offset + 1]) + bcd2dec (data[offset + 2]);
+			unsigned int surftime = 60 * bcd2dec (p[1]) + bcd2dec (p[2]);
 			unsigned int nsamples = surftime / interval;
 
 			for (unsigned int i = 0; i < nsamples; ++i) {
 				// Time
 				time += interval;
 				sample.time = time;
+				statistics.divetime = time;
 				if (callback) callback (DC_SAMPLE_TIME, sample, userdata);
 
 				// Vendor specific data
-				if (i == 0) {
+				if (i == 0 && DC_SAMPLE_WANTED(mask, DC_SAMPLE_VENDOR)) {
 					oceanic_atom2_parser_vendor (parser,
 						data + previous,
 						(offset - previous) + length,
@@ -886,10 +1200,10 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 			}
 
 			// Time.
-			if (parser->model == I450T || parser->model == I470TC) {
-				unsigned int minute = bcd2dec(data[offset + 0]);
-				unsigned int hour   = bcd2dec(data[offset + 1] & 0x0F);
-				unsigned int second = bcd2dec(data[offset + 2]);
+			if (layout->timestamp) {
+				unsigned int minute = bcd2dec(p[0]);
+				unsigned int hour   = bcd2dec(p[1] & 0x0F);
+				unsigned int second = bcd2dec(p[2]);
 				unsigned int timestamp = (hour * 3600) + (minute * 60 ) + second + extratime;
 				if (timestamp < time) {
 					ERROR (abstract->context, "Timestamp moved backwards.");
@@ -904,170 +1218,82 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 				time += interval;
 			}
 			sample.time = time;
+			statistics.divetime = time;
 			if (callback) callback (DC_SAMPLE_TIME, sample, userdata);
 
 			// Vendor specific data
-			oceanic_atom2_parser_vendor (parser,
-				data + previous,
-				(offset - previous) + length,
-				samplesize, callback, userdata);
+			if (DC_SAMPLE_WANTED(mask, DC_SAMPLE_VENDOR)) {
+				oceanic_atom2_parser_vendor (parser,
+					data + previous,
+					(offset - previous) + length,
+					samplesize, callback, userdata);
+			}
 
 			// Temperature (°F)
 			if (have_temperature) {
-				if (parser->model == GEO || parser->model == ATOM1 ||
-					parser->model == ELEMENT2 || parser->model == MANTA ||
-					parser->model == ZEN) {
-					temperature = data[offset + 6];
-				} else if (parser->model == TALIS) {
-					temperature = data[offset + 7];
-				} else if (parser->model == GEO20 || parser->model == VEO20 ||
-					parser->model == VEO30 || parser->model == OC1A ||
-					parser->model == OC1B || parser->model == OC1C ||
-					parser->model == OCI || parser->model == A300 ||
-					parser->model == I450T || parser->model == I300 ||
-					parser->model == I200 || parser->model == I100 ||
-					parser->model == I300C || parser->model == I200C ||
-					parser->model == GEO40 || parser->model == VEO40 ||
-					parser->model == I470TC) {
-					temperature = data[offset + 3];
-				} else if (parser->model == OCS || parser->model == TX1) {
-					temperature = data[offset + 1];
-				} else if (parser->model == VT4 || parser->model == VT41 ||
-					parser->model == ATOM3 || parser->model == ATOM31 ||
-					parser->model == A300AI || parser->model == VISION ||
-					parser->model == XPAIR) {
-					temperature = ((data[offset + 7] & 0xF0) >> 4) | ((data[offset + 7] & 0x0C) << 2) | ((data[offset + 5] & 0x0C) << 4);
-				} else if (parser->model == A300CS || parser->model == VTX ||
-					parser->model == I750TC || parser->model == PROPLUSX ||
-					parser->model == I770R|| parser->model == SAGE ||
-					parser->model == BEACON) {
-					temperature = data[offset + 11];
+				if (layout->temperature == TEMPERATURE_BYTE) {
+					temperature = p[layout->temperature_offset];
+				} else if (layout->temperature == TEMPERATURE_PACKED) {
+					temperature = ((p[7] & 0xF0) >> 4) | ((p[7] & 0x0C) << 2) | ((p[5] & 0x0C) << 4);
 				} else {
 					unsigned int sign;
-					if (parser->model == DG03 || parser->model == PROPLUS3 ||
-						parser->model == I550 || parser->model == I550C ||
-						parser->model == PROPLUS4 || parser->model == WISDOM4)
-						sign = (~data[offset + 5] & 0x04) >> 2;
-					else if (parser->model == VOYAGER2G || parser->model == AMPHOS ||
-						parser->model == AMPHOSAIR || parser->model == ZENAIR)
-						sign = (data[offset + 5] & 0x04) >> 2;
-					else if (parser->model == ATOM2 || parser->model == PROPLUS21 ||
-						parser->model == EPICA || parser->model == EPICB ||
-						parser->model == ATMOSAI2 ||
-						parser->model == WISDOM2 || parser->model == WISDOM3)
-						sign = (data[offset + 0] & 0x80) >> 7;
+					if (layout->temperature_sign == SIGN_BYTE5_INV)
+						sign = (~p[5] & 0x04) >> 2;
+					else if (layout->temperature_sign == SIGN_BYTE5)
+						sign = (p[5] & 0x04) >> 2;
+					else if (layout->temperature_sign == SIGN_BYTE0)
+						sign = (p[0] & 0x80) >> 7;
 					else
-						sign = (~data[offset + 0] & 0x80) >> 7;
+						sign = (~p[0] & 0x80) >> 7;
 					if (sign)
-						temperature -= (data[offset + 7] & 0x0C) >> 2;
+						temperature -= (p[7] & 0x0C) >> 2;
 					else
-						temperature += (data[offset + 7] & 0x0C) >> 2;
+						temperature += (p[7] & 0x0C) >> 2;
 				}
 				sample.temperature = (temperature - 32.0) * (5.0 / 9.0);
 				if (callback) callback (DC_SAMPLE_TEMPERATURE, sample, userdata);
 			}
 
 			// Tank Pressure (psi)
-			if (have_pressure) {
-				if (parser->model == OC1A || parser->model == OC1B ||
-					parser->model == OC1C || parser->model == OCI ||
-					parser->model == I450T || parser->model == I470TC)
-					pressure = (data[offset + 10] + (data[offset + 11] << 8)) & 0x0FFF;
-				else if (parser->model == VT4 || parser->model == VT41||
-					parser->model == ATOM3 || parser->model == ATOM31 ||
-					parser->model == ZENAIR ||parser->model == A300AI ||
-					parser->model == DG03 || parser->model == PROPLUS3 ||
-					parser->model == AMPHOSAIR || parser->model == I550 ||
-					parser->model == VISION || parser->model == XPAIR ||
-					parser->model == I550C || parser->model == PROPLUS4 ||
-					parser->model == WISDOM4)
-					pressure = (((data[offset + 0] & 0x03) << 8) + data[offset + 1]) * 5;
-				else if (parser->model == TX1 || parser->model == A300CS ||
-					parser->model == VTX || parser->model == I750TC ||
-					parser->model == PROPLUSX || parser->model == I770R ||
-					parser->model == SAGE || parser->model == BEACON)
-					pressure = array_uint16_le (data + offset + 4);
+			if (pressure_type != PRESSURE_NONE) {
+				if (pressure_type == PRESSURE_BYTE10)
+					pressure = (p[10] + (p[11] << 8)) & 0x0FFF;
+				else if (pressure_type == PRESSURE_BYTE0)
+					pressure = (((p[0] & 0x03) << 8) + p[1]) * 5;
+				else if (pressure_type == PRESSURE_BYTE4)
+					pressure = array_uint16_le (p + 4);
 				else
-					pressure -= data[offset + 1];
+					pressure -= p[1];
 				sample.pressure.tank = tank;
 				sample.pressure.value = pressure * PSI / BAR;
 				if (callback) callback (DC_SAMPLE_PRESSURE, sample, userdata);
 			}
 
 			// Depth (1/16 ft)
-			unsigned int depth;
-			if (parser->mode == FREEDIVE)
-				depth = array_uint16_le (data + offset);
-			else if (parser->model == GEO20 || parser->model == VEO20 ||
-				parser->model == VEO30 || parser->model == OC1A ||
-				parser->model == OC1B || parser->model == OC1C ||
-				parser->model == OCI || parser->model == A300 ||
-				parser->model == I450T || parser->model == I300 ||
-				parser->model == I200 || parser->model == I100 ||
-				parser->model == I300C || parser->model == I200C ||
-				parser->model == GEO40 || parser->model == VEO40 ||
-				parser->model == I470TC)
-				depth = (data[offset + 4] + (data[offset + 5] << 8)) & 0x0FFF;
-			else if (parser->model == ATOM1)
-				depth = data[offset + 3] * 16;
-			else
-				depth = (data[offset + 2] + (data[offset + 3] << 8)) & 0x0FFF;
+			unsigned int depth = (array_uint16_le (p + depth_offset) & depth_mask) << depth_shift;
 			sample.depth = depth / 16.0 * FEET;
+			if (statistics.maxdepth < sample.depth)
+				statistics.maxdepth = sample.depth;
 			if (callback) callback (DC_SAMPLE_DEPTH, sample, userdata);
 
 			// Gas mix
-			unsigned int have_gasmix = 0;
-			unsigned int gasmix = 0;
-			if (parser->model == TX1) {
-				gasmix = data[offset] & 0x07;
-				have_gasmix = 1;
-			}
-			if (have_gasmix && gasmix != gasmix_previous) {
-				if (gasmix < 1 || gasmix > parser->ngasmixes) {
-					ERROR (abstract->context, "Invalid gas mix index (%u).", gasmix);
-					return DC_STATUS_DATAFORMAT;
+			if (layout->gasmix_mask) {
+				unsigned int gasmix = p[0] & layout->gasmix_mask;
+				if (gasmix != gasmix_previous) {
+					if (gasmix < 1 || gasmix > parser->ngasmixes) {
+						ERROR (abstract->context, "Invalid gas mix index (%u).", gasmix);
+						return DC_STATUS_DATAFORMAT;
+					}
+					sample.gasmix = gasmix - 1;
+					if (callback) callback (DC_SAMPLE_GASMIX, sample, userdata);
+					gasmix_previous = gasmix;
 				}
-				sample.gasmix = gasmix - 1;
-				if (callback) callback (DC_SAMPLE_GASMIX, sample, userdata);
-				gasmix_previous = gasmix;
 			}
 
 			// NDL / Deco
-			unsigned int have_deco = 0;
-			unsigned int decostop = 0, decotime = 0;
-			if (parser->model == A300CS || parser->model == VTX ||
-				parser->model == I750TC || parser->model == SAGE ||
-				parser->model == PROPLUSX || parser->model == I770R ||
-				parser->model == BEACON) {
-				decostop = (data[offset + 15] & 0x70) >> 4;
-				decotime = array_uint16_le(data + offset + 6) & 0x03FF;
-				have_deco = 1;
-			} else if (parser->model == ZEN || parser->model == DG03) {
-				decostop = (data[offset + 5] & 0xF0) >> 4;
-				decotime = array_uint16_le(data + offset + 4) & 0x0FFF;
-				have_deco = 1;
-			} else if (parser->model == TX1) {
-				decostop = data[offset + 10];
-				decotime = array_uint16_le(data + offset + 6);
-				have_deco = 1;
-			} else if (parser->model == ATOM31 || parser->model == VISION ||
-				parser->model == XPAIR || parser->model == I550 ||
-				parser->model == I550C || parser->model == WISDOM4) {
-				decostop = (data[offset + 5] & 0xF0) >> 4;
-				decotime = array_uint16_le(data + offset + 4) & 0x03FF;
-				have_deco = 1;
-			} else if (parser->model == I200 || parser->model == I300 ||
-				parser->model == OC1A || parser->model == OC1B ||
-				parser->model == OC1C || parser->model == OCI ||
-				parser->model == I100 || parser->model == I300C ||
-				parser->model == I450T || parser->model == I200C ||
-				parser->model == GEO40 || parser->model == VEO40 ||
-				parser->model == I470TC) {
-				decostop = (data[offset + 7] & 0xF0) >> 4;
-				decotime = array_uint16_le(data + offset + 6) & 0x0FFF;
-				have_deco = 1;
-			}
-			if (have_deco) {
+			if (layout->deco && DC_SAMPLE_WANTED(mask, DC_SAMPLE_DECO)) {
+				unsigned int decostop = (p[layout->decostop_offset] & layout->decostop_mask) >> layout->decostop_shift;
+				unsigned int decotime = array_uint16_le(p + layout->decotime_offset) & layout->decotime_mask;
 				if (decostop) {
 					sample.deco.type = DC_DECO_DECOSTOP;
 					sample.deco.depth = decostop * 10 * FEET;
@@ -1079,35 +1305,14 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 				if (callback) callback (DC_SAMPLE_DECO, sample, userdata);
 			}
 
-			unsigned int have_rbt = 0;
-			unsigned int rbt = 0;
-			if (parser->model == ATOM31) {
-				rbt = array_uint16_le(data + offset + 6) & 0x01FF;
-				have_rbt = 1;
-			} else if (parser->model == I450T || parser->model == OC1A ||
-				parser->model == OC1B || parser->model == OC1C ||
-				parser->model == OCI || parser->model == PROPLUSX ||
-				parser->model == I770R || parser->model == I470TC) {
-				rbt = array_uint16_le(data + offset + 8) & 0x01FF;
-				have_rbt = 1;
-			} else if (parser->model == VISION || parser->model == XPAIR ||
-				parser->model == I550 || parser->model == I550C ||
-				parser->model == WISDOM4) {
-				rbt = array_uint16_le(data + offset + 6) & 0x03FF;
-				have_rbt = 1;
-			}
-			if (have_rbt) {
-				sample.rbt = rbt;
+			// Remaining bottom time
+			if (layout->rbt && DC_SAMPLE_WANTED(mask, DC_SAMPLE_RBT)) {
+				sample.rbt = array_uint16_le(p + layout->rbt_offset) & layout->rbt_mask;
 				if (callback) callback (DC_SAMPLE_RBT, sample, userdata);
 			}
 
 			// Bookmarks
-			unsigned int have_bookmark = 0;
-			if (parser->model == OC1A || parser->model == OC1B ||
-				parser->model == OC1C || parser->model == OCI) {
-				have_bookmark = data[offset + 12] & 0x80;
-			}
-			if (have_bookmark) {
+			if (layout->bookmark && DC_SAMPLE_WANTED(mask, DC_SAMPLE_EVENT) && (p[12] & 0x80)) {
 				sample.event.type = SAMPLE_EVENT_BOOKMARK;
 				sample.event.time = 0;
 				sample.event.flags = 0;
@@ -1122,5 +1327,19 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 		offset += length;
 	}
 
+	// Cache the profile statistics.
+	parser->cached = PROFILE;
+	parser->divetime = statistics.divetime;
+	parser->maxdepth = statistics.maxdepth;
+
 	return DC_STATUS_SUCCESS;
 }
+
+
+static dc_status_t
+oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
+{
+	oceanic_atom2_parser_t *parser = (oceanic_atom2_parser_t *) abstract;
+
+	return oceanic_atom2_parser_samples (parser, abstract->samplemask, callback, userdata);
+}
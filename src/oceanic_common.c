@@ -40,6 +40,12 @@
 
 #define INVALID 0
 
+typedef struct oceanic_common_dive_t {
+	unsigned int entry;
+	unsigned int size;
+	unsigned int gap;
+} oceanic_common_dive_t;
+
 static unsigned int
 get_profile_first (const unsigned char data[], const oceanic_common_layout_t *layout, unsigned int pagesize)
 {
@@ -381,9 +387,17 @@ oceanic_common_device_profile (dc_device_t *abstract, dc_event_progress_t *progr
 	const unsigned char *logbooks = dc_buffer_get_data (logbook);
 	unsigned int rb_logbook_size = dc_buffer_get_size (logbook);
 
-	// Go through the logbook entries a first time, to get the end of
-	// profile pointer and calculate the total amount of bytes in the
+	// Plan the profile reads. The logbook entries are validated once,
+	// and the profile ranges of the dives are collected, together with
+	// the end of profile pointer and the total amount of bytes in the
 	// profile ringbuffer.
+	oceanic_common_dive_t *dives = (oceanic_common_dive_t *) malloc ((rb_logbook_size / layout->rb_logbook_entry_size + 1) * sizeof (oceanic_common_dive_t));
+	if (dives == NULL) {
+		ERROR (abstract->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	unsigned int ndives = 0;
 	unsigned int rb_profile_end  = INVALID;
 	unsigned int rb_profile_size = 0;
 
@@ -441,6 +455,12 @@ oceanic_common_device_profile (dc_device_t *abstract, dc_event_progress_t *progr
 			break;
 		}
 
+		// Add the dive to the plan.
+		dives[ndives].entry = entry;
+		dives[ndives].size = rb_entry_size;
+		dives[ndives].gap = gap;
+		ndives++;
+
 		// Update the total profile size.
 		rb_profile_size += rb_entry_size + gap;
 
@@ -455,6 +475,7 @@ oceanic_common_device_profile (dc_device_t *abstract, dc_event_progress_t *progr
 
 	// Exit if there are no dives.
 	if (rb_profile_size == 0) {
+		free (dives);
 		return status;
 	}
 
@@ -463,6 +484,7 @@ oceanic_common_device_profile (dc_device_t *abstract, dc_event_progress_t *progr
 	rc = dc_rbstream_new (&rbstream, abstract, PAGESIZE, PAGESIZE * device->multipage, layout->rb_profile_begin, layout->rb_profile_end, rb_profile_end);
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR (abstract->context, "Failed to create the ringbuffer stream.");
+		free (dives);
 		return rc;
 	}
 
@@ -471,59 +493,17 @@ oceanic_common_device_profile (dc_device_t *abstract, dc_event_progress_t *progr
 	if (profiles == NULL) {
 		ERROR (abstract->context, "Failed to allocate memory.");
 		dc_rbstream_free (rbstream);
+		free (dives);
 		return DC_STATUS_NOMEMORY;
 	}
 
 	// Keep track of the current position.
 	unsigned int offset = rb_profile_size + rb_logbook_size;
 
-	// Traverse the logbook ringbuffer backwards to retrieve the most recent
-	// dives first. The logbook ringbuffer is linearized at this point, so
-	// we do not have to take into account any memory wrapping near the end
-	// of the memory buffer.
-	remaining = rb_profile_size;
-	previous = rb_profile_end;
-	entry = rb_logbook_size;
-	while (entry) {
-		// Move to the start of the current entry.
-		entry -= layout->rb_logbook_entry_size;
-
-		// Skip uninitialized entries.
-		if (array_isequal (logbooks + entry, layout->rb_logbook_entry_size, 0xFF)) {
-			WARNING (abstract->context, "Skipping uninitialized logbook entry!");
-			continue;
-		}
-
-		// Get the profile pointers.
-		unsigned int rb_entry_first = get_profile_first (logbooks + entry, layout, pagesize);
-		unsigned int rb_entry_last  = get_profile_last (logbooks + entry, layout, pagesize);
-		if (rb_entry_first < layout->rb_profile_begin ||
-			rb_entry_first >= layout->rb_profile_end ||
-			rb_entry_last < layout->rb_profile_begin ||
-			rb_entry_last >= layout->rb_profile_end)
-		{
-			ERROR (abstract->context, "Invalid ringbuffer pointer detected (0x%06x 0x%06x).",
-				rb_entry_first, rb_entry_last);
-			status = DC_STATUS_DATAFORMAT;
-			continue;
-		}
-
-		// Calculate the end pointer and the number of bytes.
-		unsigned int rb_entry_end   = RB_PROFILE_INCR (rb_entry_last, pagesize, layout);
-		unsigned int rb_entry_size  = RB_PROFILE_DISTANCE (rb_entry_first, rb_entry_last, layout) + pagesize;
-
-		// Skip gaps between the profiles.
-		unsigned int gap = 0;
-		if (rb_entry_end != previous) {
-			WARNING (abstract->context, "Profiles are not continuous.");
-			gap = RB_PROFILE_DISTANCE (rb_entry_end, previous, layout);
-		}
-
-		// Make sure the profile size is valid.
-		if (rb_entry_size + gap > remaining) {
-			WARNING (abstract->context, "Unexpected profile size.");
-			break;
-		}
+	// Read the planned dives, most recent dives first.
+	for (unsigned int i = 0; i < ndives; ++i) {
+		unsigned int rb_entry_size = dives[i].size;
+		unsigned int gap = dives[i].gap;
 
 		// Move to the start of the current dive.
 		offset -= rb_entry_size + gap;
@@ -536,13 +516,10 @@ oceanic_common_device_profile (dc_device_t *abstract, dc_event_progress_t *progr
 			break;
 		}
 
-		remaining -= rb_entry_size + gap;
-		previous = rb_entry_first;
-
 		// Prepend the logbook entry to the profile data. The memory buffer is
 		// large enough to store this entry.
 		offset -= layout->rb_logbook_entry_size;
-		memcpy (profiles + offset, logbooks + entry, layout->rb_logbook_entry_size);
+		memcpy (profiles + offset, logbooks + dives[i].entry, layout->rb_logbook_entry_size);
 
 		// Remove padding from the profile.
 		if (layout->highmem) {
@@ -567,6 +544,7 @@ oceanic_common_device_profile (dc_device_t *abstract, dc_event_progress_t *progr
 
 	dc_rbstream_free (rbstream);
 	free (profiles);
+	free (dives);
 
 	return status;
 }
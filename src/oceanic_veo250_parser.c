@@ -49,17 +49,22 @@ struct oceanic_veo250_parser_t {
 };
 
 static dc_status_t oceanic_veo250_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t oceanic_veo250_parser_reset (dc_parser_t *abstract);
 static dc_status_t oceanic_veo250_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t oceanic_veo250_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t oceanic_veo250_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t oceanic_veo250_parser_samples (oceanic_veo250_parser_t *parser, unsigned int mask, dc_sample_callback_t callback, void *userdata);
 
 static const dc_parser_vtable_t oceanic_veo250_parser_vtable = {
 	sizeof(oceanic_veo250_parser_t),
 	DC_FAMILY_OCEANIC_VEO250,
 	oceanic_veo250_parser_set_data, /* set_data */
+	oceanic_veo250_parser_reset, /* reset */
 	oceanic_veo250_parser_get_datetime, /* datetime */
 	oceanic_veo250_parser_get_field, /* fields */
+	NULL, /* summary */
 	oceanic_veo250_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -92,7 +97,7 @@ oceanic_veo250_parser_create (dc_parser_t **out, dc_context_t *context, unsigned
 
 
 static dc_status_t
-oceanic_veo250_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+oceanic_veo250_parser_reset (dc_parser_t *abstract)
 {
 	oceanic_veo250_parser_t *parser = (oceanic_veo250_parser_t *) abstract;
 
@@ -104,6 +109,12 @@ oceanic_veo250_parser_set_data (dc_parser_t *abstract, const unsigned char *data
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+oceanic_veo250_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
 
 static dc_status_t
 oceanic_veo250_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
@@ -146,15 +157,9 @@ oceanic_veo250_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, un
 		return DC_STATUS_DATAFORMAT;
 
 	if (!parser->cached) {
-		sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
-		dc_status_t rc = oceanic_veo250_parser_samples_foreach (
-			abstract, sample_statistics_cb, &statistics);
+		dc_status_t rc = oceanic_veo250_parser_samples (parser, DC_SAMPLE_MASK_STATISTICS, NULL, NULL);
 		if (rc != DC_STATUS_SUCCESS)
 			return rc;
-
-		parser->cached = 1;
-		parser->divetime = statistics.divetime;
-		parser->maxdepth = statistics.maxdepth;
 	}
 
 	unsigned int footer = size - PAGESIZE;
@@ -189,12 +194,18 @@ oceanic_veo250_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, un
 }
 
 
+/*
+ * Walk the profile data. The dive time and maximum depth are collected on
+ * the fly, so the profile statistics come for free with the first walk.
+ * Sample types that are not in the mask are not decoded.
+ */
 static dc_status_t
-oceanic_veo250_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
+oceanic_veo250_parser_samples (oceanic_veo250_parser_t *parser, unsigned int mask, dc_sample_callback_t callback, void *userdata)
 {
-	oceanic_veo250_parser_t *parser = (oceanic_veo250_parser_t *) abstract;
+	dc_parser_t *abstract = (dc_parser_t *) parser;
 	const unsigned char *data = abstract->data;
 	unsigned int size = abstract->size;
+	sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
 
 	if (size < 7 * PAGESIZE / 2)
 		return DC_STATUS_DATAFORMAT;
@@ -234,29 +245,36 @@ oceanic_veo250_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback
 		// Time.
 		time += interval;
 		sample.time = time;
+		statistics.divetime = time;
 		if (callback) callback (DC_SAMPLE_TIME, sample, userdata);
 
 		// Vendor specific data
-		sample.vendor.type = SAMPLE_VENDOR_OCEANIC_VEO250;
-		sample.vendor.size = PAGESIZE / 2;
-		sample.vendor.data = data + offset;
-		if (callback) callback (DC_SAMPLE_VENDOR, sample, userdata);
+		if (DC_SAMPLE_WANTED(mask, DC_SAMPLE_VENDOR)) {
+			sample.vendor.type = SAMPLE_VENDOR_OCEANIC_VEO250;
+			sample.vendor.size = PAGESIZE / 2;
+			sample.vendor.data = data + offset;
+			if (callback) callback (DC_SAMPLE_VENDOR, sample, userdata);
+		}
 
 		// Depth (ft)
 		unsigned int depth = data[offset + 2];
 		sample.depth = depth * FEET;
+		if (statistics.maxdepth < sample.depth)
+			statistics.maxdepth = sample.depth;
 		if (callback) callback (DC_SAMPLE_DEPTH, sample, userdata);
 
 		// Temperature (°F)
-		unsigned int temperature;
-		if (parser->model == REACTPRO || parser->model == REACTPROWHITE ||
-			parser->model == INSIGHT) {
-			temperature = data[offset + 6];
-		} else {
-			temperature = data[offset + 7];
+		if (DC_SAMPLE_WANTED(mask, DC_SAMPLE_TEMPERATURE)) {
+			unsigned int temperature;
+			if (parser->model == REACTPRO || parser->model == REACTPROWHITE ||
+				parser->model == INSIGHT) {
+				temperature = data[offset + 6];
+			} else {
+				temperature = data[offset + 7];
+			}
+			sample.temperature = (temperature - 32.0) * (5.0 / 9.0);
+			if (callback) callback (DC_SAMPLE_TEMPERATURE, sample, userdata);
 		}
-		sample.temperature = (temperature - 32.0) * (5.0 / 9.0);
-		if (callback) callback (DC_SAMPLE_TEMPERATURE, sample, userdata);
 
 		// NDL / Deco
 		unsigned int have_deco = 0;
@@ -271,7 +289,7 @@ oceanic_veo250_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback
 			decotime = array_uint16_le(data + offset + 4) & 0x0FFF;
 			have_deco = 1;
 		}
-		if (have_deco) {
+		if (have_deco && DC_SAMPLE_WANTED(mask, DC_SAMPLE_DECO)) {
 			if (decostop) {
 				sample.deco.type = DC_DECO_DECOSTOP;
 				sample.deco.depth = decostop * 10 * FEET;
@@ -286,5 +304,19 @@ oceanic_veo250_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback
 		offset += PAGESIZE / 2;
 	}
 
+	// Cache the profile statistics.
+	parser->cached = 1;
+	parser->divetime = statistics.divetime;
+	parser->maxdepth = statistics.maxdepth;
+
 	return DC_STATUS_SUCCESS;
 }
+
+
+static dc_status_t
+oceanic_veo250_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
+{
+	oceanic_veo250_parser_t *parser = (oceanic_veo250_parser_t *) abstract;
+
+	return oceanic_veo250_parser_samples (parser, abstract->samplemask, callback, userdata);
+}
@@ -45,17 +45,22 @@ struct oceanic_vtpro_parser_t {
 };
 
 static dc_status_t oceanic_vtpro_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t oceanic_vtpro_parser_reset (dc_parser_t *abstract);
 static dc_status_t oceanic_vtpro_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t oceanic_vtpro_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t oceanic_vtpro_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t oceanic_vtpro_parser_samples (oceanic_vtpro_parser_t *parser, unsigned int mask, dc_sample_callback_t callback, void *userdata);
 
 static const dc_parser_vtable_t oceanic_vtpro_parser_vtable = {
 	sizeof(oceanic_vtpro_parser_t),
 	DC_FAMILY_OCEANIC_VTPRO,
 	oceanic_vtpro_parser_set_data, /* set_data */
+	oceanic_vtpro_parser_reset, /* reset */
 	oceanic_vtpro_parser_get_datetime, /* datetime */
 	oceanic_vtpro_parser_get_field, /* fields */
+	NULL, /* summary */
 	oceanic_vtpro_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -88,7 +93,7 @@ oceanic_vtpro_parser_create (dc_parser_t **out, dc_context_t *context, unsigned
 
 
 static dc_status_t
-oceanic_vtpro_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+oceanic_vtpro_parser_reset (dc_parser_t *abstract)
 {
 	oceanic_vtpro_parser_t *parser = (oceanic_vtpro_parser_t *) abstract;
 
@@ -100,6 +105,12 @@ oceanic_vtpro_parser_set_data (dc_parser_t *abstract, const unsigned char *data,
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+oceanic_vtpro_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
 
 static dc_status_t
 oceanic_vtpro_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
@@ -159,15 +170,9 @@ oceanic_vtpro_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 		return DC_STATUS_DATAFORMAT;
 
 	if (!parser->cached) {
-		sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
-		dc_status_t rc = oceanic_vtpro_parser_samples_foreach (
-			abstract, sample_statistics_cb, &statistics);
+		dc_status_t rc = oceanic_vtpro_parser_samples (parser, DC_SAMPLE_MASK_STATISTICS, NULL, NULL);
 		if (rc != DC_STATUS_SUCCESS)
 			return rc;
-
-		parser->cached = 1;
-		parser->divetime = statistics.divetime;
-		parser->maxdepth = statistics.maxdepth;
 	}
 
 	unsigned int footer = size - PAGESIZE;
@@ -229,10 +234,16 @@ oceanic_vtpro_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 }
 
 
+/*
+ * Walk the profile data. The dive time and maximum depth are collected on
+ * the fly, so the profile statistics come for free with the first walk.
+ * Sample types that are not in the mask are not decoded.
+ */
 static dc_status_t
-oceanic_vtpro_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
+oceanic_vtpro_parser_samples (oceanic_vtpro_parser_t *parser, unsigned int mask, dc_sample_callback_t callback, void *userdata)
 {
-	oceanic_vtpro_parser_t *parser = (oceanic_vtpro_parser_t *) abstract;
+	dc_parser_t *abstract = (dc_parser_t *) parser;
+	sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
 
 	const unsigned char *data = abstract->data;
 	unsigned int size = abstract->size;
@@ -331,13 +342,16 @@ oceanic_vtpro_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 		else
 			time = timestamp * 60 + (i + 1) * 60.0 / count + 0.5;
 		sample.time = time;
+		statistics.divetime = time;
 		if (callback) callback (DC_SAMPLE_TIME, sample, userdata);
 
 		// Vendor specific data
-		sample.vendor.type = SAMPLE_VENDOR_OCEANIC_VTPRO;
-		sample.vendor.size = PAGESIZE / 2;
-		sample.vendor.data = data + offset;
-		if (callback) callback (DC_SAMPLE_VENDOR, sample, userdata);
+		if (DC_SAMPLE_WANTED(mask, DC_SAMPLE_VENDOR)) {
+			sample.vendor.type = SAMPLE_VENDOR_OCEANIC_VTPRO;
+			sample.vendor.size = PAGESIZE / 2;
+			sample.vendor.data = data + offset;
+			if (callback) callback (DC_SAMPLE_VENDOR, sample, userdata);
+		}
 
 		// Depth (ft)
 		unsigned int depth = 0;
@@ -347,20 +361,24 @@ oceanic_vtpro_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 			depth = data[offset + 3];
 		}
 		sample.depth = depth * FEET;
+		if (statistics.maxdepth < sample.depth)
+			statistics.maxdepth = sample.depth;
 		if (callback) callback (DC_SAMPLE_DEPTH, sample, userdata);
 
 		// Temperature (°F)
-		unsigned int temperature = 0;
-		if (parser->model == AERIS500AI) {
-			temperature = (array_uint16_le(data + offset + 6) & 0x0FF0) >> 4;
-		} else {
-			temperature = data[offset + 6];
+		if (DC_SAMPLE_WANTED(mask, DC_SAMPLE_TEMPERATURE)) {
+			unsigned int temperature = 0;
+			if (parser->model == AERIS500AI) {
+				temperature = (array_uint16_le(data + offset + 6) & 0x0FF0) >> 4;
+			} else {
+				temperature = data[offset + 6];
+			}
+			sample.temperature = (temperature - 32.0) * (5.0 / 9.0);
+			if (callback) callback (DC_SAMPLE_TEMPERATURE, sample, userdata);
 		}
-		sample.temperature = (temperature - 32.0) * (5.0 / 9.0);
-		if (callback) callback (DC_SAMPLE_TEMPERATURE, sample, userdata);
 
 		// NDL / Deco
-		if (parser->model != AERIS500AI) {
+		if (parser->model != AERIS500AI && DC_SAMPLE_WANTED(mask, DC_SAMPLE_DECO)) {
 			unsigned int decostop = (data[offset + 5] & 0xF0) >> 4;
 			unsigned int decotime = array_uint16_le(data + offset + 4) & 0x0FFF;
 			if (decostop) {
@@ -377,5 +395,19 @@ oceanic_vtpro_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 		offset += PAGESIZE / 2;
 	}
 
+	// Cache the profile statistics.
+	parser->cached = 1;
+	parser->divetime = statistics.divetime;
+	parser->maxdepth = statistics.maxdepth;
+
 	return DC_STATUS_SUCCESS;
 }
+
+
+static dc_status_t
+oceanic_vtpro_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
+{
+	oceanic_vtpro_parser_t *parser = (oceanic_vtpro_parser_t *) abstract;
+
+	return oceanic_vtpro_parser_samples (parser, abstract->samplemask, callback, userdata);
+}
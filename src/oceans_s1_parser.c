@@ -24,6 +24,7 @@ struct oceans_s1_parser_t {
 };
 
 static dc_status_t oceans_s1_parser_set_data(dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t oceans_s1_parser_reset(dc_parser_t *abstract);
 static dc_status_t oceans_s1_parser_get_datetime(dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t oceans_s1_parser_get_field(dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t oceans_s1_parser_samples_foreach(dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -32,9 +33,12 @@ static const dc_parser_vtable_t oceans_s1_parser_vtable = {
 	sizeof(oceans_s1_parser_t),
 	DC_FAMILY_OCEANS_S1,
 	oceans_s1_parser_set_data, /* set_data */
+	oceans_s1_parser_reset, /* reset */
 	oceans_s1_parser_get_datetime, /* datetime */
 	oceans_s1_parser_get_field, /* fields */
+	NULL, /* summary */
 	oceans_s1_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -172,6 +176,20 @@ oceans_s1_parse_dive(struct oceans_s1_parser_t *s1, const unsigned char *data, d
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+oceans_s1_parser_reset(dc_parser_t *abstract)
+{
+	struct oceans_s1_parser_t *s1 = (struct oceans_s1_parser_t *)abstract;
+
+	s1->divenr = 0;
+	s1->maxdepth = 0;
+	s1->duration = 0;
+	s1->date = 0;
+	dc_field_clear(&s1->cache);
+
+	return DC_STATUS_SUCCESS;
+}
+
 static dc_status_t
 oceans_s1_parser_set_data(dc_parser_t *abstract, const unsigned char *data, unsigned int size)
 {
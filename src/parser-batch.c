@@ -0,0 +1,312 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+
+#include <libdivecomputer/parser.h>
+
+#include "context-private.h"
+#include "thread.h"
+
+/*
+ * Every worker owns a contiguous range of dives, which it processes from
+ * the front. A worker that runs out of work steals the upper half of the
+ * remaining range of another worker. The results are stored per dive,
+ * and handed over to the consumer in input order by the calling thread.
+ */
+
+typedef struct batch_t batch_t;
+
+typedef struct batch_queue_t {
+	dc_mutex_t *mutex;
+	unsigned int begin;
+	unsigned int end;
+} batch_queue_t;
+
+typedef struct batch_result_t {
+	dc_status_t status;
+	void *result;
+	int done;
+} batch_result_t;
+
+typedef struct batch_worker_t {
+	batch_t *batch;
+	unsigned int id;
+	dc_thread_t *thread;
+} batch_worker_t;
+
+struct batch_t {
+	dc_context_t *context;
+	dc_descriptor_t *descriptor;
+	unsigned int devtime;
+	dc_ticks_t systime;
+	const unsigned char *const *data;
+	const unsigned int *size;
+	unsigned int count;
+	dc_parser_batch_work_t work;
+	void *userdata;
+	unsigned int nthreads;
+	batch_queue_t *queues;
+	batch_worker_t *workers;
+	batch_result_t *results;
+	/* Protects the fields below and the results. */
+	dc_mutex_t *mutex;
+	dc_cond_t *cond;
+	unsigned int next;
+	int cancelled;
+};
+
+static dc_status_t
+batch_parse (batch_t *batch, dc_parser_t *parser, unsigned int index, void **result)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	status = dc_parser_set_data (parser, batch->data[index], batch->size[index]);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (batch->context, "Failed to set the data of dive %u.", index);
+		return status;
+	}
+
+	return batch->work (parser, index, result, batch->userdata);
+}
+
+static int
+batch_take (batch_t *batch, unsigned int id, unsigned int *index)
+{
+	batch_queue_t *queue = batch->queues + id;
+
+	dc_mutex_lock (queue->mutex);
+	if (queue->begin < queue->end) {
+		*index = queue->begin++;
+		dc_mutex_unlock (queue->mutex);
+		return 1;
+	}
+	dc_mutex_unlock (queue->mutex);
+
+	for (unsigned int i = 1; i < batch->nthreads; ++i) {
+		batch_queue_t *victim = batch->queues + (id + i) % batch->nthreads;
+		unsigned int begin = 0, end = 0;
+
+		dc_mutex_lock (victim->mutex);
+		if (victim->begin < victim->end) {
+			unsigned int n = (victim->end - victim->begin + 1) / 2;
+			end = victim->end;
+			begin = end - n;
+			victim->end = begin;
+		}
+		dc_mutex_unlock (victim->mutex);
+
+		if (begin < end) {
+			// The victim and our own queue are never locked at the same
+			// time, to avoid a deadlock between two thieves.
+			dc_mutex_lock (queue->mutex);
+			queue->begin = begin + 1;
+			queue->end = end;
+			dc_mutex_unlock (queue->mutex);
+
+			*index = begin;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static void
+batch_worker (void *userdata)
+{
+	batch_worker_t *worker = (batch_worker_t *) userdata;
+	batch_t *batch = worker->batch;
+	dc_parser_t *parser = NULL;
+	unsigned int index = 0;
+	int cancelled = 0;
+
+	dc_status_t rc = dc_parser_new2 (&parser, batch->context, batch->descriptor, batch->devtime, batch->systime);
+	if (rc != DC_STATUS_SUCCESS) {
+		ERROR (batch->context, "Failed to create the parser for worker %u.", worker->id);
+	}
+
+	while (!cancelled && batch_take (batch, worker->id, &index)) {
+		dc_status_t status = rc;
+		void *result = NULL;
+
+		if (parser) {
+			status = batch_parse (batch, parser, index, &result);
+		}
+
+		dc_mutex_lock (batch->mutex);
+		batch->results[index].status = status;
+		batch->results[index].result = result;
+		batch->results[index].done = 1;
+		if (index == batch->next) {
+			dc_cond_signal (batch->cond);
+		}
+		cancelled = batch->cancelled;
+		dc_mutex_unlock (batch->mutex);
+	}
+
+	dc_parser_destroy (parser);
+}
+
+static dc_status_t
+batch_sequential (batch_t *batch, dc_parser_batch_consume_t consume)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_parser_t *parser = NULL;
+
+	status = dc_parser_new2 (&parser, batch->context, batch->descriptor, batch->devtime, batch->systime);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (batch->context, "Failed to create the parser.");
+		return status;
+	}
+
+	for (unsigned int i = 0; i < batch->count; ++i) {
+		void *result = NULL;
+		dc_status_t rc = batch_parse (batch, parser, i, &result);
+		if (!consume (i, rc, result, batch->userdata))
+			break;
+	}
+
+	dc_parser_destroy (parser);
+
+	return DC_STATUS_SUCCESS;
+}
+
+static void
+batch_free (batch_t *batch)
+{
+	if (batch->queues) {
+		for (unsigned int i = 0; i < batch->nthreads; ++i) {
+			dc_mutex_free (batch->queues[i].mutex);
+		}
+	}
+
+	dc_cond_free (batch->cond);
+	dc_mutex_free (batch->mutex);
+	free (batch->results);
+	free (batch->workers);
+	free (batch->queues);
+}
+
+dc_status_t
+dc_parser_batch (dc_context_t *context, dc_descriptor_t *descriptor, unsigned int devtime, dc_ticks_t systime,
+	const unsigned char *const data[], const unsigned int size[], unsigned int count, unsigned int nthreads,
+	dc_parser_batch_work_t work, dc_parser_batch_consume_t consume, void *userdata)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	batch_t batch = {0};
+	unsigned int nstarted = 0;
+
+	if (descriptor == NULL || work == NULL || consume == NULL ||
+		(count && (data == NULL || size == NULL)))
+		return DC_STATUS_INVALIDARGS;
+
+	if (count == 0)
+		return DC_STATUS_SUCCESS;
+
+	if (nthreads == 0)
+		nthreads = dc_thread_ncpus ();
+	if (nthreads > count)
+		nthreads = count;
+
+	batch.context = context;
+	batch.descriptor = descriptor;
+	batch.devtime = devtime;
+	batch.systime = systime;
+	batch.data = data;
+	batch.size = size;
+	batch.count = count;
+	batch.work = work;
+	batch.userdata = userdata;
+	batch.nthreads = nthreads;
+
+	if (nthreads == 1)
+		return batch_sequential (&batch, consume);
+
+	batch.queues = (batch_queue_t *) calloc (nthreads, sizeof (batch_queue_t));
+	batch.workers = (batch_worker_t *) calloc (nthreads, sizeof (batch_worker_t));
+	batch.results = (batch_result_t *) calloc (count, sizeof (batch_result_t));
+	if (batch.queues == NULL || batch.workers == NULL || batch.results == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto out;
+	}
+
+	status = dc_mutex_new (&batch.mutex);
+	if (status == DC_STATUS_SUCCESS)
+		status = dc_cond_new (&batch.cond);
+	for (unsigned int i = 0; i < nthreads && status == DC_STATUS_SUCCESS; ++i) {
+		status = dc_mutex_new (&batch.queues[i].mutex);
+		batch.queues[i].begin = (unsigned long long) count * i / nthreads;
+		batch.queues[i].end = (unsigned long long) count * (i + 1) / nthreads;
+	}
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (context, "Failed to create the synchronization primitives.");
+		goto out;
+	}
+
+	// Threads that fail to start are not fatal. Their work is stolen by
+	// the others.
+	for (unsigned int i = 0; i < nthreads; ++i) {
+		batch.workers[i].batch = &batch;
+		batch.workers[i].id = i;
+		if (dc_thread_new (&batch.workers[i].thread, batch_worker, batch.workers + i) == DC_STATUS_SUCCESS) {
+			nstarted++;
+		}
+	}
+
+	if (nstarted == 0) {
+		WARNING (context, "Failed to start the worker threads.");
+		status = batch_sequential (&batch, consume);
+		goto out;
+	}
+
+	for (unsigned int i = 0; i < count; ++i) {
+		dc_mutex_lock (batch.mutex);
+		batch.next = i;
+		while (!batch.results[i].done)
+			dc_cond_wait (batch.cond, batch.mutex);
+		dc_mutex_unlock (batch.mutex);
+
+		if (!consume (i, batch.results[i].status, batch.results[i].result, userdata)) {
+			dc_mutex_lock (batch.mutex);
+			batch.cancelled = 1;
+			dc_mutex_unlock (batch.mutex);
+			break;
+		}
+	}
+
+	for (unsigned int i = 0; i < nthreads; ++i) {
+		dc_thread_join (batch.workers[i].thread);
+	}
+
+	// Release the results that were produced after the cancellation.
+	if (batch.cancelled) {
+		for (unsigned int i = batch.next + 1; i < count; ++i) {
+			if (batch.results[i].done)
+				consume (i, DC_STATUS_CANCELLED, batch.results[i].result, userdata);
+		}
+	}
+
+out:
+	batch_free (&batch);
+	return status;
+}
@@ -24,6 +24,7 @@
 
 #include <libdivecomputer/context.h>
 #include <libdivecomputer/parser.h>
+#include <libdivecomputer/buffer.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,6 +40,7 @@ struct dc_parser_t {
 	dc_context_t *context;
 	const unsigned char *data;
 	unsigned int size;
+	unsigned int samplemask;
 };
 
 struct dc_parser_vtable_t {
@@ -48,12 +50,18 @@ struct dc_parser_vtable_t {
 
 	dc_status_t (*set_data) (dc_parser_t *parser, const unsigned char *data, unsigned int size);
 
+	dc_status_t (*reset) (dc_parser_t *parser);
+
 	dc_status_t (*datetime) (dc_parser_t *parser, dc_datetime_t *datetime);
 
 	dc_status_t (*field) (dc_parser_t *parser, dc_field_type_t type, unsigned int flags, void *value);
 
+	dc_status_t (*summary) (dc_parser_t *parser, dc_summary_t *summary);
+
 	dc_status_t (*samples_foreach) (dc_parser_t *parser, dc_sample_callback_t callback, void *userdata);
 
+	dc_status_t (*samples_batch) (dc_parser_t *parser, dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata);
+
 	dc_status_t (*destroy) (dc_parser_t *parser);
 };
 
@@ -66,6 +74,24 @@ dc_parser_deallocate (dc_parser_t *parser);
 int
 dc_parser_isinstance (dc_parser_t *parser, const dc_parser_vtable_t *vtable);
 
+typedef dc_status_t (*dc_parser_field_t) (dc_parser_t *parser, dc_field_type_t type, unsigned int flags, void *value);
+
+/*
+ * Fill the summary with the datetime and the values returned by the
+ * field function. Fields reported as unsupported are left out.
+ */
+dc_status_t
+dc_parser_fill_summary (dc_parser_t *parser, dc_parser_field_t field, dc_summary_t *summary);
+
+/*
+ * Check whether a sample type is in the sample mask. Parsers use this to
+ * skip decoding work that only feeds the sample callback.
+ */
+#define DC_SAMPLE_WANTED(mask, type) (((mask) & DC_SAMPLE_MASK(type)) != 0)
+
+/* The sample types needed for the profile statistics. */
+#define DC_SAMPLE_MASK_STATISTICS (DC_SAMPLE_MASK(DC_SAMPLE_TIME) | DC_SAMPLE_MASK(DC_SAMPLE_DEPTH))
+
 typedef struct sample_statistics_t {
 	unsigned int divetime;
 	double maxdepth;
@@ -76,6 +102,46 @@ typedef struct sample_statistics_t {
 void
 sample_statistics_cb (dc_sample_type_t type, dc_sample_value_t value, void *userdata);
 
+/*
+ * Sample batch writer
+ *
+ * Parsers with a native samples_batch implementation store the values
+ * directly in the columns of the batch. A new sample is started with
+ * dc_sample_batch_next(), which delivers the batch first when it is
+ * full. Values that precede the first sample go to the row returned by
+ * dc_sample_batch_row(). Event names must remain valid until the batch
+ * is delivered. The remaining samples are delivered with
+ * dc_sample_batch_flush().
+ */
+typedef struct dc_sample_batch_writer_t {
+	dc_context_t *context;
+	dc_sample_batch_t *batch;
+	dc_sample_batch_callback_t callback;
+	void *userdata;
+	/* Copied event names (generic adapter only). */
+	dc_buffer_t *strings;
+	unsigned int *names;
+} dc_sample_batch_writer_t;
+
+void
+dc_sample_batch_init (dc_sample_batch_writer_t *writer, dc_context_t *context, dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata);
+
+unsigned int
+dc_sample_batch_next (dc_sample_batch_writer_t *writer);
+
+unsigned int
+dc_sample_batch_row (dc_sample_batch_writer_t *writer);
+
+/*
+ * Add an event to the current sample. Returns NULL if events are not
+ * collected, or if the sample has too many events.
+ */
+dc_sample_event_t *
+dc_sample_batch_event (dc_sample_batch_writer_t *writer);
+
+void
+dc_sample_batch_flush (dc_sample_batch_writer_t *writer);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
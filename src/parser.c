@@ -19,9 +19,14 @@
  * MA 02110-1301 USA
  */
 
+#include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <assert.h>
 
+#include <libdivecomputer/buffer.h>
+
 #include "suunto_d9.h"
 #include "suunto_eon.h"
 #include "suunto_eonsteel.h"
@@ -70,6 +75,8 @@
 #include "parser-private.h"
 #include "device-private.h"
 
+#define C_ARRAY_SIZE(array) (sizeof (array) / sizeof *(array))
+
 #define REACTPROWHITE 0x4354
 
 static dc_status_t
@@ -252,6 +259,7 @@ dc_parser_allocate (dc_context_t *context, const dc_parser_vtable_t *vtable)
 	parser->context = context;
 	parser->data = NULL;
 	parser->size = 0;
+	parser->samplemask = DC_SAMPLE_MASK_ALL;
 
 	return parser;
 }
@@ -291,6 +299,8 @@ dc_parser_set_data (dc_parser_t *parser, const unsigned char *data, unsigned int
 	if (parser->vtable->set_data == NULL)
 		return DC_STATUS_UNSUPPORTED;
 
+	dc_parser_reset (parser);
+
 	parser->data = data;
 	parser->size = size;
 
@@ -298,6 +308,34 @@ dc_parser_set_data (dc_parser_t *parser, const unsigned char *data, unsigned int
 }
 
 
+dc_status_t
+dc_parser_reset (dc_parser_t *parser)
+{
+	if (parser == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	parser->data = NULL;
+	parser->size = 0;
+
+	if (parser->vtable->reset == NULL)
+		return DC_STATUS_SUCCESS;
+
+	return parser->vtable->reset (parser);
+}
+
+
+dc_status_t
+dc_parser_set_sample_mask (dc_parser_t *parser, unsigned int mask)
+{
+	if (parser == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	parser->samplemask = mask;
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 dc_status_t
 dc_parser_get_datetime (dc_parser_t *parser, dc_datetime_t *datetime)
 {
@@ -323,6 +361,79 @@ dc_parser_get_field (dc_parser_t *parser, dc_field_type_t type, unsigned int fla
 }
 
 
+dc_status_t
+dc_parser_fill_summary (dc_parser_t *parser, dc_parser_field_t field, dc_summary_t *summary)
+{
+	static const struct {
+		dc_field_type_t type;
+		unsigned int mask;
+		size_t offset;
+	} table[] = {
+		{DC_FIELD_DIVETIME,            DC_SUMMARY_DIVETIME,     offsetof (dc_summary_t, divetime)},
+		{DC_FIELD_MAXDEPTH,            DC_SUMMARY_MAXDEPTH,     offsetof (dc_summary_t, maxdepth)},
+		{DC_FIELD_AVGDEPTH,            DC_SUMMARY_AVGDEPTH,     offsetof (dc_summary_t, avgdepth)},
+		{DC_FIELD_DIVEMODE,            DC_SUMMARY_DIVEMODE,     offsetof (dc_summary_t, divemode)},
+		{DC_FIELD_GASMIX_COUNT,        DC_SUMMARY_GASMIX_COUNT, offsetof (dc_summary_t, ngasmixes)},
+		{DC_FIELD_TEMPERATURE_MINIMUM, DC_SUMMARY_TEMPERATURE,  offsetof (dc_summary_t, temperature)},
+		{DC_FIELD_SALINITY,            DC_SUMMARY_SALINITY,     offsetof (dc_summary_t, salinity)},
+		{DC_FIELD_ATMOSPHERIC,         DC_SUMMARY_ATMOSPHERIC,  offsetof (dc_summary_t, atmospheric)},
+	};
+
+	dc_status_t rc = DC_STATUS_SUCCESS;
+
+	if (parser->vtable->datetime) {
+		rc = parser->vtable->datetime (parser, &summary->datetime);
+		if (rc == DC_STATUS_SUCCESS)
+			summary->fields |= DC_SUMMARY_DATETIME;
+		else if (rc != DC_STATUS_UNSUPPORTED)
+			return rc;
+	}
+
+	if (field == NULL)
+		return DC_STATUS_SUCCESS;
+
+	for (size_t i = 0; i < C_ARRAY_SIZE(table); ++i) {
+		rc = field (parser, table[i].type, 0, (unsigned char *) summary + table[i].offset);
+		if (rc == DC_STATUS_SUCCESS)
+			summary->fields |= table[i].mask;
+		else if (rc != DC_STATUS_UNSUPPORTED)
+			return rc;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+
+dc_status_t
+dc_parser_get_summary (dc_parser_t *parser, dc_summary_t *summary)
+{
+	if (parser == NULL || summary == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	memset (summary, 0, sizeof (*summary));
+
+	if (parser->vtable->summary)
+		return parser->vtable->summary (parser, summary);
+
+	return dc_parser_fill_summary (parser, parser->vtable->field, summary);
+}
+
+
+typedef struct sample_mask_t {
+	unsigned int mask;
+	dc_sample_callback_t callback;
+	void *userdata;
+} sample_mask_t;
+
+static void
+sample_mask_cb (dc_sample_type_t type, dc_sample_value_t value, void *userdata)
+{
+	sample_mask_t *state = (sample_mask_t *) userdata;
+
+	if (DC_SAMPLE_WANTED(state->mask, type))
+		state->callback (type, value, state->userdata);
+}
+
 dc_status_t
 dc_parser_samples_foreach (dc_parser_t *parser, dc_sample_callback_t callback, void *userdata)
 {
@@ -332,10 +443,334 @@ dc_parser_samples_foreach (dc_parser_t *parser, dc_sample_callback_t callback, v
 	if (parser->vtable->samples_foreach == NULL)
 		return DC_STATUS_UNSUPPORTED;
 
+	// Drop the unwanted sample types that were not already skipped by
+	// the parser itself.
+	if (callback && parser->samplemask != DC_SAMPLE_MASK_ALL) {
+		sample_mask_t state;
+		state.mask = parser->samplemask;
+		state.callback = callback;
+		state.userdata = userdata;
+		return parser->vtable->samples_foreach (parser, sample_mask_cb, &state);
+	}
+
 	return parser->vtable->samples_foreach (parser, callback, userdata);
 }
 
 
+static void
+sample_batch_clear (dc_sample_batch_t *batch, unsigned int row)
+{
+	if (batch->time)
+		batch->time[row] = 0;
+	if (batch->depth)
+		batch->depth[row] = NAN;
+	if (batch->temperature)
+		batch->temperature[row] = NAN;
+	if (batch->pressure) {
+		for (unsigned int i = 0; i < batch->ntanks; ++i) {
+			batch->pressure[row * batch->ntanks + i] = NAN;
+		}
+	}
+	if (batch->ppo2)
+		batch->ppo2[row] = NAN;
+	if (batch->deco) {
+		batch->deco[row].type = DC_DECO_NDL;
+		batch->deco[row].time = 0;
+		batch->deco[row].depth = NAN;
+	}
+}
+
+static void
+sample_batch_copy (dc_sample_batch_t *batch, unsigned int dst, unsigned int src)
+{
+	if (batch->time)
+		batch->time[dst] = batch->time[src];
+	if (batch->depth)
+		batch->depth[dst] = batch->depth[src];
+	if (batch->temperature)
+		batch->temperature[dst] = batch->temperature[src];
+	if (batch->pressure) {
+		memcpy (batch->pressure + dst * batch->ntanks,
+			batch->pressure + src * batch->ntanks,
+			batch->ntanks * sizeof (batch->pressure[0]));
+	}
+	if (batch->ppo2)
+		batch->ppo2[dst] = batch->ppo2[src];
+	if (batch->deco)
+		batch->deco[dst] = batch->deco[src];
+}
+
+/*
+ * Deliver all samples collected so far to the callback. If the last
+ * sample is still incomplete (keep is non-zero), it's moved to the
+ * front of the buffers together with its events, and only the
+ * completed samples are delivered.
+ */
+static void
+sample_batch_deliver (dc_sample_batch_writer_t *writer, int keep)
+{
+	dc_sample_batch_t *batch = writer->batch;
+	unsigned int total = batch->count;
+	unsigned int totalevents = batch->nevents;
+	unsigned int count = total;
+	unsigned int nevents = totalevents;
+
+	if (keep && count) {
+		count--;
+		while (nevents && batch->events[nevents - 1].sample == count)
+			nevents--;
+	}
+
+	if (count) {
+		if (writer->names) {
+			const char *strings = (const char *) dc_buffer_get_data (writer->strings);
+			for (unsigned int i = 0; i < nevents; ++i) {
+				if (writer->names[i])
+					batch->events[i].name = strings + writer->names[i] - 1;
+			}
+		}
+
+		batch->count = count;
+		batch->nevents = nevents;
+		writer->callback (batch, writer->userdata);
+	}
+
+	if (count < total) {
+		// Move the incomplete sample to the front.
+		if (count)
+			sample_batch_copy (batch, 0, count);
+
+		for (unsigned int i = nevents; i < totalevents; ++i) {
+			batch->events[i - nevents] = batch->events[i];
+			batch->events[i - nevents].sample = 0;
+		}
+
+		if (writer->names) {
+			size_t offset = dc_buffer_get_size (writer->strings);
+			for (unsigned int i = nevents; i < totalevents; ++i) {
+				if (writer->names[i] && writer->names[i] - 1 < offset)
+					offset = writer->names[i] - 1;
+			}
+			for (unsigned int i = nevents; i < totalevents; ++i) {
+				writer->names[i - nevents] = writer->names[i] ? writer->names[i] - offset : 0;
+			}
+			dc_buffer_slice (writer->strings, offset, dc_buffer_get_size (writer->strings) - offset);
+		}
+
+		batch->count = 1;
+		batch->nevents = totalevents - nevents;
+	} else {
+		batch->count = 0;
+		batch->nevents = 0;
+		if (writer->strings)
+			dc_buffer_clear (writer->strings);
+	}
+}
+
+void
+dc_sample_batch_init (dc_sample_batch_writer_t *writer, dc_context_t *context, dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata)
+{
+	writer->context = context;
+	writer->batch = batch;
+	writer->callback = callback;
+	writer->userdata = userdata;
+	writer->strings = NULL;
+	writer->names = NULL;
+
+	batch->count = 0;
+	batch->nevents = 0;
+}
+
+unsigned int
+dc_sample_batch_next (dc_sample_batch_writer_t *writer)
+{
+	dc_sample_batch_t *batch = writer->batch;
+
+	if (batch->count == batch->capacity)
+		sample_batch_deliver (writer, 0);
+
+	unsigned int row = batch->count++;
+	sample_batch_clear (batch, row);
+
+	return row;
+}
+
+unsigned int
+dc_sample_batch_row (dc_sample_batch_writer_t *writer)
+{
+	dc_sample_batch_t *batch = writer->batch;
+
+	// Values reported before the first time sample belong to an
+	// implicit sample at time zero.
+	if (batch->count == 0) {
+		sample_batch_clear (batch, 0);
+		batch->count = 1;
+	}
+
+	return batch->count - 1;
+}
+
+dc_sample_event_t *
+dc_sample_batch_event (dc_sample_batch_writer_t *writer)
+{
+	dc_sample_batch_t *batch = writer->batch;
+
+	if (batch->events == NULL || batch->maxevents == 0)
+		return NULL;
+
+	unsigned int row = dc_sample_batch_row (writer);
+	if (batch->nevents == batch->maxevents) {
+		sample_batch_deliver (writer, 1);
+		if (batch->nevents == batch->maxevents) {
+			WARNING (writer->context, "Too many events in a single sample.");
+			return NULL;
+		}
+		row = 0;
+	}
+
+	dc_sample_event_t *event = batch->events + batch->nevents++;
+	event->sample = row;
+	event->type = 0;
+	event->time = 0;
+	event->flags = 0;
+	event->value = 0;
+	event->name = NULL;
+
+	return event;
+}
+
+void
+dc_sample_batch_flush (dc_sample_batch_writer_t *writer)
+{
+	if (writer->batch->count)
+		sample_batch_deliver (writer, 0);
+}
+
+static void
+sample_batch_cb (dc_sample_type_t type, dc_sample_value_t value, void *userdata)
+{
+	dc_sample_batch_writer_t *writer = (dc_sample_batch_writer_t *) userdata;
+	dc_sample_batch_t *batch = writer->batch;
+	dc_sample_event_t *event = NULL;
+	unsigned int row = 0;
+
+	switch (type) {
+	case DC_SAMPLE_TIME:
+		row = dc_sample_batch_next (writer);
+		if (batch->time)
+			batch->time[row] = value.time;
+		break;
+	case DC_SAMPLE_DEPTH:
+		row = dc_sample_batch_row (writer);
+		if (batch->depth)
+			batch->depth[row] = value.depth;
+		break;
+	case DC_SAMPLE_TEMPERATURE:
+		row = dc_sample_batch_row (writer);
+		if (batch->temperature)
+			batch->temperature[row] = value.temperature;
+		break;
+	case DC_SAMPLE_PRESSURE:
+		row = dc_sample_batch_row (writer);
+		if (batch->pressure && value.pressure.tank < batch->ntanks)
+			batch->pressure[row * batch->ntanks + value.pressure.tank] = value.pressure.value;
+		break;
+	case DC_SAMPLE_PPO2:
+		row = dc_sample_batch_row (writer);
+		if (batch->ppo2)
+			batch->ppo2[row] = value.ppo2;
+		break;
+	case DC_SAMPLE_DECO:
+		row = dc_sample_batch_row (writer);
+		if (batch->deco) {
+			batch->deco[row].type = value.deco.type;
+			batch->deco[row].time = value.deco.time;
+			batch->deco[row].depth = value.deco.depth;
+		}
+		break;
+	case DC_SAMPLE_EVENT:
+		event = dc_sample_batch_event (writer);
+		if (event == NULL)
+			break;
+		event->type = value.event.type;
+		event->time = value.event.time;
+		event->flags = value.event.flags;
+		event->value = value.event.value;
+		writer->names[event - batch->events] = 0;
+		if (value.event.name) {
+			// The name is copied, because the parser may release it
+			// long before the batch is delivered.
+			size_t offset = dc_buffer_get_size (writer->strings);
+			if (dc_buffer_append (writer->strings, (const unsigned char *) value.event.name, strlen (value.event.name) + 1)) {
+				writer->names[event - batch->events] = offset + 1;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+static dc_status_t
+dc_parser_samples_batch_fallback (dc_parser_t *parser, dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_sample_batch_writer_t writer;
+
+	if (parser->vtable->samples_foreach == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	dc_sample_batch_init (&writer, parser->context, batch, callback, userdata);
+
+	writer.strings = dc_buffer_new (0);
+	if (writer.strings == NULL) {
+		ERROR (parser->context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	if (batch->events && batch->maxevents) {
+		writer.names = (unsigned int *) malloc (batch->maxevents * sizeof (unsigned int));
+		if (writer.names == NULL) {
+			ERROR (parser->context, "Failed to allocate memory.");
+			dc_buffer_free (writer.strings);
+			return DC_STATUS_NOMEMORY;
+		}
+	}
+
+	status = dc_parser_samples_foreach (parser, sample_batch_cb, &writer);
+	if (status == DC_STATUS_SUCCESS) {
+		dc_sample_batch_flush (&writer);
+	}
+
+	free (writer.names);
+	dc_buffer_free (writer.strings);
+
+	return status;
+}
+
+
+dc_status_t
+dc_parser_samples_batch (dc_parser_t *parser, dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata)
+{
+	if (parser == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (batch == NULL || batch->capacity == 0 || callback == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (batch->pressure && batch->ntanks == 0)
+		return DC_STATUS_INVALIDARGS;
+
+	batch->count = 0;
+	batch->nevents = 0;
+
+	if (parser->vtable->samples_batch == NULL)
+		return dc_parser_samples_batch_fallback (parser, batch, callback, userdata);
+
+	return parser->vtable->samples_batch (parser, batch, callback, userdata);
+}
+
+
 dc_status_t
 dc_parser_destroy (dc_parser_t *parser)
 {
@@ -344,6 +779,8 @@ dc_parser_destroy (dc_parser_t *parser)
 	if (parser == NULL)
 		return DC_STATUS_SUCCESS;
 
+	dc_parser_reset (parser);
+
 	if (parser->vtable->destroy) {
 		status = parser->vtable->destroy (parser);
 	}
@@ -49,6 +49,7 @@ struct reefnet_sensus_parser_t {
 };
 
 static dc_status_t reefnet_sensus_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t reefnet_sensus_parser_reset (dc_parser_t *abstract);
 static dc_status_t reefnet_sensus_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t reefnet_sensus_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t reefnet_sensus_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -57,9 +58,12 @@ static const dc_parser_vtable_t reefnet_sensus_parser_vtable = {
 	sizeof(reefnet_sensus_parser_t),
 	DC_FAMILY_REEFNET_SENSUS,
 	reefnet_sensus_parser_set_data, /* set_data */
+	reefnet_sensus_parser_reset, /* reset */
 	reefnet_sensus_parser_get_datetime, /* datetime */
 	reefnet_sensus_parser_get_field, /* fields */
+	NULL, /* summary */
 	reefnet_sensus_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -95,7 +99,7 @@ reefnet_sensus_parser_create (dc_parser_t **out, dc_context_t *context, unsigned
 
 
 static dc_status_t
-reefnet_sensus_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+reefnet_sensus_parser_reset (dc_parser_t *abstract)
 {
 	reefnet_sensus_parser_t *parser = (reefnet_sensus_parser_t*) abstract;
 
@@ -107,6 +111,12 @@ reefnet_sensus_parser_set_data (dc_parser_t *abstract, const unsigned char *data
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+reefnet_sensus_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
 
 dc_status_t
 reefnet_sensus_parser_set_calibration (dc_parser_t *abstract, double atmospheric, double hydrostatic)
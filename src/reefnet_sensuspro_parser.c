@@ -48,6 +48,7 @@ struct reefnet_sensuspro_parser_t {
 };
 
 static dc_status_t reefnet_sensuspro_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t reefnet_sensuspro_parser_reset (dc_parser_t *abstract);
 static dc_status_t reefnet_sensuspro_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t reefnet_sensuspro_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t reefnet_sensuspro_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -56,9 +57,12 @@ static const dc_parser_vtable_t reefnet_sensuspro_parser_vtable = {
 	sizeof(reefnet_sensuspro_parser_t),
 	DC_FAMILY_REEFNET_SENSUSPRO,
 	reefnet_sensuspro_parser_set_data, /* set_data */
+	reefnet_sensuspro_parser_reset, /* reset */
 	reefnet_sensuspro_parser_get_datetime, /* datetime */
 	reefnet_sensuspro_parser_get_field, /* fields */
+	NULL, /* summary */
 	reefnet_sensuspro_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -94,7 +98,7 @@ reefnet_sensuspro_parser_create (dc_parser_t **out, dc_context_t *context, unsig
 
 
 static dc_status_t
-reefnet_sensuspro_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+reefnet_sensuspro_parser_reset (dc_parser_t *abstract)
 {
 	reefnet_sensuspro_parser_t *parser = (reefnet_sensuspro_parser_t*) abstract;
 
@@ -106,6 +110,12 @@ reefnet_sensuspro_parser_set_data (dc_parser_t *abstract, const unsigned char *d
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+reefnet_sensuspro_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
 
 dc_status_t
 reefnet_sensuspro_parser_set_calibration (dc_parser_t *abstract, double atmospheric, double hydrostatic)
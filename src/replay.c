@@ -0,0 +1,676 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <libdivecomputer/replay.h>
+#include <libdivecomputer/ioctl.h>
+#include <libdivecomputer/buffer.h>
+
+#include "iostream-private.h"
+#include "context-private.h"
+#include "platform.h"
+#include "timer.h"
+#include "trace.h"
+
+static dc_status_t dc_record_set_timeout (dc_iostream_t *abstract, int timeout);
+static dc_status_t dc_record_set_break (dc_iostream_t *abstract, unsigned int value);
+static dc_status_t dc_record_set_dtr (dc_iostream_t *abstract, unsigned int value);
+static dc_status_t dc_record_set_rts (dc_iostream_t *abstract, unsigned int value);
+static dc_status_t dc_record_get_lines (dc_iostream_t *abstract, unsigned int *value);
+static dc_status_t dc_record_get_available (dc_iostream_t *abstract, size_t *value);
+static dc_status_t dc_record_configure (dc_iostream_t *abstract, unsigned int baudrate, unsigned int databits, dc_parity_t parity, dc_stopbits_t stopbits, dc_flowcontrol_t flowcontrol);
+static dc_status_t dc_record_poll (dc_iostream_t *abstract, int timeout);
+static dc_status_t dc_record_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual);
+static dc_status_t dc_record_write (dc_iostream_t *abstract, const void *data, size_t size, size_t *actual);
+static dc_status_t dc_record_ioctl (dc_iostream_t *abstract, unsigned int request, void *data, size_t size);
+static dc_status_t dc_record_flush (dc_iostream_t *abstract);
+static dc_status_t dc_record_purge (dc_iostream_t *abstract, dc_direction_t direction);
+static dc_status_t dc_record_sleep (dc_iostream_t *abstract, unsigned int milliseconds);
+static dc_status_t dc_record_close (dc_iostream_t *abstract);
+
+static dc_status_t dc_replay_get_available (dc_iostream_t *abstract, size_t *value);
+static dc_status_t dc_replay_poll (dc_iostream_t *abstract, int timeout);
+static dc_status_t dc_replay_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual);
+static dc_status_t dc_replay_write (dc_iostream_t *abstract, const void *data, size_t size, size_t *actual);
+static dc_status_t dc_replay_ioctl (dc_iostream_t *abstract, unsigned int request, void *data, size_t size);
+static dc_status_t dc_replay_sleep (dc_iostream_t *abstract, unsigned int milliseconds);
+static dc_status_t dc_replay_close (dc_iostream_t *abstract);
+
+typedef struct dc_record_t {
+	/* Base class. */
+	dc_iostream_t base;
+	/* Internal state. */
+	dc_iostream_t *iostream;
+	dc_timer_t *timer;
+	FILE *fp;
+} dc_record_t;
+
+typedef struct dc_replay_t {
+	/* Base class. */
+	dc_iostream_t base;
+	/* Internal state. */
+	dc_buffer_t *transcript;
+	unsigned int flags;
+	dc_timer_t *timer;
+	dc_usecs_t start;
+	/* Incoming data. */
+	size_t rd_offset;
+	const unsigned char *rd_data;
+	unsigned int rd_size;
+	dc_status_t rd_status;
+	/* Outgoing data. */
+	size_t wr_offset;
+	const unsigned char *wr_data;
+	unsigned int wr_size;
+	unsigned long long wr_total;
+	/* Ioctl requests. */
+	size_t io_offset;
+} dc_replay_t;
+
+static const dc_iostream_vtable_t dc_record_vtable = {
+	sizeof(dc_record_t),
+	dc_record_set_timeout, /* set_timeout */
+	dc_record_set_break, /* set_break */
+	dc_record_set_dtr, /* set_dtr */
+	dc_record_set_rts, /* set_rts */
+	dc_record_get_lines, /* get_lines */
+	dc_record_get_available, /* get_available */
+	dc_record_configure, /* configure */
+	dc_record_poll, /* poll */
+	dc_record_read, /* read */
+	dc_record_write, /* write */
+	dc_record_ioctl, /* ioctl */
+	dc_record_flush, /* flush */
+	dc_record_purge, /* purge */
+	dc_record_sleep, /* sleep */
+	dc_record_close, /* close */
+};
+
+static const dc_iostream_vtable_t dc_replay_vtable = {
+	sizeof(dc_replay_t),
+	NULL, /* set_timeout */
+	NULL, /* set_break */
+	NULL, /* set_dtr */
+	NULL, /* set_rts */
+	NULL, /* get_lines */
+	dc_replay_get_available, /* get_available */
+	NULL, /* configure */
+	dc_replay_poll, /* poll */
+	dc_replay_read, /* read */
+	dc_replay_write, /* write */
+	dc_replay_ioctl, /* ioctl */
+	NULL, /* flush */
+	NULL, /* purge */
+	dc_replay_sleep, /* sleep */
+	dc_replay_close, /* close */
+};
+
+dc_status_t
+dc_record_open (dc_iostream_t **out, dc_context_t *context, dc_iostream_t *base, const char *filename)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_record_t *record = NULL;
+
+	if (out == NULL || base == NULL || filename == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	INFO (context, "Open: filename=%s", filename);
+
+	// Allocate memory.
+	record = (dc_record_t *) dc_iostream_allocate (context, &dc_record_vtable, dc_iostream_get_transport (base));
+	if (record == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	record->iostream = base;
+	record->timer = NULL;
+	record->fp = NULL;
+
+	status = dc_timer_new (&record->timer);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (context, "Failed to create a high resolution timer.");
+		goto error_free;
+	}
+
+	record->fp = fopen (filename, "wb");
+	if (record->fp == NULL) {
+		ERROR (context, "Failed to open the transcript file.");
+		status = DC_STATUS_IO;
+		goto error_timer_free;
+	}
+
+	status = dc_trace_write_header (record->fp);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (context, "Failed to write the transcript file.");
+		goto error_close;
+	}
+
+	*out = (dc_iostream_t *) record;
+
+	return DC_STATUS_SUCCESS;
+
+error_close:
+	fclose (record->fp);
+error_timer_free:
+	dc_timer_free (record->timer);
+error_free:
+	dc_iostream_deallocate ((dc_iostream_t *) record);
+	return status;
+}
+
+static void
+dc_record_append (dc_record_t *record, dc_trace_t type, unsigned int request, dc_status_t status, const void *data, size_t size)
+{
+	dc_trace_record_t entry;
+
+	entry.timestamp = 0;
+	entry.type = type;
+	entry.transport = record->base.transport;
+	entry.request = request;
+	entry.status = status;
+	entry.data = (const unsigned char *) data;
+	entry.size = size;
+	dc_timer_now (record->timer, &entry.timestamp);
+
+	if (dc_trace_write_record (record->fp, &entry) != DC_STATUS_SUCCESS) {
+		WARNING (record->base.context, "Failed to write the transcript file.");
+	}
+}
+
+static dc_status_t
+dc_record_set_timeout (dc_iostream_t *abstract, int timeout)
+{
+	dc_record_t *record = (dc_record_t *) abstract;
+
+	return dc_iostream_set_timeout (record->iostream, timeout);
+}
+
+static dc_status_t
+dc_record_set_break (dc_iostream_t *abstract, unsigned int value)
+{
+	dc_record_t *record = (dc_record_t *) abstract;
+
+	return dc_iostream_set_break (record->iostream, value);
+}
+
+static dc_status_t
+dc_record_set_dtr (dc_iostream_t *abstract, unsigned int value)
+{
+	dc_record_t *record = (dc_record_t *) abstract;
+
+	return dc_iostream_set_dtr (record->iostream, value);
+}
+
+static dc_status_t
+dc_record_set_rts (dc_iostream_t *abstract, unsigned int value)
+{
+	dc_record_t *record = (dc_record_t *) abstract;
+
+	return dc_iostream_set_rts (record->iostream, value);
+}
+
+static dc_status_t
+dc_record_get_lines (dc_iostream_t *abstract, unsigned int *value)
+{
+	dc_record_t *record = (dc_record_t *) abstract;
+
+	return dc_iostream_get_lines (record->iostream, value);
+}
+
+static dc_status_t
+dc_record_get_available (dc_iostream_t *abstract, size_t *value)
+{
+	dc_record_t *record = (dc_record_t *) abstract;
+
+	return dc_iostream_get_available (record->iostream, value);
+}
+
+static dc_status_t
+dc_record_configure (dc_iostream_t *abstract, unsigned int baudrate, unsigned int databits, dc_parity_t parity, dc_stopbits_t stopbits, dc_flowcontrol_t flowcontrol)
+{
+	dc_record_t *record = (dc_record_t *) abstract;
+
+	return dc_iostream_configure (record->iostream, baudrate, databits, parity, stopbits, flowcontrol);
+}
+
+static dc_status_t
+dc_record_poll (dc_iostream_t *abstract, int timeout)
+{
+	dc_record_t *record = (dc_record_t *) abstract;
+
+	return dc_iostream_poll (record->iostream, timeout);
+}
+
+static dc_status_t
+dc_record_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual)
+{
+	dc_record_t *record = (dc_record_t *) abstract;
+
+	dc_status_t status = dc_iostream_read (record->iostream, data, size, actual);
+	dc_record_append (record, DC_TRACE_READ, 0, status, data, *actual);
+
+	return status;
+}
+
+static dc_status_t
+dc_record_write (dc_iostream_t *abstract, const void *data, size_t size, size_t *actual)
+{
+	dc_record_t *record = (dc_record_t *) abstract;
+
+	dc_status_t status = dc_iostream_write (record->iostream, data, size, actual);
+	dc_record_append (record, DC_TRACE_WRITE, 0, status, data, *actual);
+
+	return status;
+}
+
+static dc_status_t
+dc_record_ioctl (dc_iostream_t *abstract, unsigned int request, void *data, size_t size)
+{
+	dc_record_t *record = (dc_record_t *) abstract;
+
+	if (DC_IOCTL_DIR(request) & DC_IOCTL_DIR_WRITE) {
+		dc_record_append (record, DC_TRACE_IOCTL_WRITE, request, DC_STATUS_SUCCESS, data, size);
+	}
+
+	dc_status_t status = dc_iostream_ioctl (record->iostream, request, data, size);
+
+	if (DC_IOCTL_DIR(request) & DC_IOCTL_DIR_READ) {
+		dc_record_append (record, DC_TRACE_IOCTL_READ, request, status, data, size);
+	}
+
+	return status;
+}
+
+static dc_status_t
+dc_record_flush (dc_iostream_t *abstract)
+{
+	dc_record_t *record = (dc_record_t *) abstract;
+
+	return dc_iostream_flush (record->iostream);
+}
+
+static dc_status_t
+dc_record_purge (dc_iostream_t *abstract, dc_direction_t direction)
+{
+	dc_record_t *record = (dc_record_t *) abstract;
+
+	return dc_iostream_purge (record->iostream, direction);
+}
+
+static dc_status_t
+dc_record_sleep (dc_iostream_t *abstract, unsigned int milliseconds)
+{
+	dc_record_t *record = (dc_record_t *) abstract;
+
+	return dc_iostream_sleep (record->iostream, milliseconds);
+}
+
+static dc_status_t
+dc_record_close (dc_iostream_t *abstract)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_record_t *record = (dc_record_t *) abstract;
+
+	if (fclose (record->fp) != 0) {
+		ERROR (abstract->context, "Failed to write the transcript file.");
+		status = DC_STATUS_IO;
+	}
+
+	dc_timer_free (record->timer);
+
+	dc_status_t rc = dc_iostream_close (record->iostream);
+	if (status == DC_STATUS_SUCCESS)
+		status = rc;
+
+	return status;
+}
+
+static dc_buffer_t *
+dc_replay_load (dc_context_t *context, const char *filename)
+{
+	dc_buffer_t *buffer = NULL;
+	FILE *fp = NULL;
+
+	fp = fopen (filename, "rb");
+	if (fp == NULL) {
+		ERROR (context, "Failed to open the transcript file.");
+		return NULL;
+	}
+
+	buffer = dc_buffer_new (0);
+	if (buffer == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		goto error_close;
+	}
+
+	for (;;) {
+		unsigned char block[4096];
+		size_t nbytes = fread (block, 1, sizeof (block), fp);
+		if (nbytes == 0)
+			break;
+
+		if (!dc_buffer_append (buffer, block, nbytes)) {
+			ERROR (context, "Failed to allocate memory.");
+			goto error_free;
+		}
+	}
+
+	if (ferror (fp)) {
+		ERROR (context, "Failed to read the transcript file.");
+		goto error_free;
+	}
+
+	fclose (fp);
+
+	return buffer;
+
+error_free:
+	dc_buffer_free (buffer);
+error_close:
+	fclose (fp);
+	return NULL;
+}
+
+dc_status_t
+dc_replay_open (dc_iostream_t **out, dc_context_t *context, const char *filename, unsigned int flags)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_replay_t *replay = NULL;
+	dc_buffer_t *transcript = NULL;
+	dc_trace_record_t first;
+	dc_transport_t transport = DC_TRANSPORT_SERIAL;
+	size_t offset = DC_TRACE_HEADERSIZE;
+
+	if (out == NULL || filename == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	INFO (context, "Open: filename=%s", filename);
+
+	transcript = dc_replay_load (context, filename);
+	if (transcript == NULL) {
+		return DC_STATUS_IO;
+	}
+
+	const unsigned char *data = dc_buffer_get_data (transcript);
+	size_t size = dc_buffer_get_size (transcript);
+
+	status = dc_trace_check_header (data, size);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (context, "Invalid transcript file.");
+		goto error_buffer_free;
+	}
+
+	// The transport and start time are taken from the first record.
+	first.timestamp = 0;
+	status = dc_trace_read_record (data, size, &offset, &first);
+	if (status == DC_STATUS_SUCCESS) {
+		transport = first.transport;
+	} else if (status != DC_STATUS_DONE) {
+		ERROR (context, "Invalid transcript file.");
+		goto error_buffer_free;
+	}
+
+	// Allocate memory.
+	replay = (dc_replay_t *) dc_iostream_allocate (context, &dc_replay_vtable, transport);
+	if (replay == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_buffer_free;
+	}
+
+	replay->transcript = transcript;
+	replay->flags = flags;
+	replay->timer = NULL;
+	replay->start = first.timestamp;
+	replay->rd_offset = DC_TRACE_HEADERSIZE;
+	replay->rd_data = NULL;
+	replay->rd_size = 0;
+	replay->rd_status = DC_STATUS_SUCCESS;
+	replay->wr_offset = DC_TRACE_HEADERSIZE;
+	replay->wr_data = NULL;
+	replay->wr_size = 0;
+	replay->wr_total = 0;
+	replay->io_offset = DC_TRACE_HEADERSIZE;
+
+	status = dc_timer_new (&replay->timer);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (context, "Failed to create a high resolution timer.");
+		goto error_free;
+	}
+
+	*out = (dc_iostream_t *) replay;
+
+	return DC_STATUS_SUCCESS;
+
+error_free:
+	dc_iostream_deallocate ((dc_iostream_t *) replay);
+error_buffer_free:
+	dc_buffer_free (transcript);
+	return status;
+}
+
+/*
+ * Find the next record of one of the two types, starting at the given
+ * offset, and advance the offset past it.
+ */
+static dc_status_t
+dc_replay_next (dc_replay_t *replay, size_t *offset, dc_trace_t type1, dc_trace_t type2, dc_trace_record_t *record)
+{
+	const unsigned char *data = dc_buffer_get_data (replay->transcript);
+	size_t size = dc_buffer_get_size (replay->transcript);
+
+	for (;;) {
+		dc_status_t status = dc_trace_read_record (data, size, offset, record);
+		if (status != DC_STATUS_SUCCESS) {
+			if (status != DC_STATUS_DONE)
+				ERROR (replay->base.context, "Truncated transcript file.");
+			return DC_STATUS_DONE;
+		}
+
+		if (record->type == type1 || record->type == type2)
+			return DC_STATUS_SUCCESS;
+	}
+}
+
+static void
+dc_replay_wait (dc_replay_t *replay, dc_usecs_t timestamp)
+{
+	dc_usecs_t now = 0;
+
+	if ((replay->flags & DC_REPLAY_TIMING) == 0 || timestamp < replay->start)
+		return;
+
+	if (dc_timer_now (replay->timer, &now) != DC_STATUS_SUCCESS)
+		return;
+
+	dc_usecs_t target = timestamp - replay->start;
+	if (target > now) {
+		dc_platform_sleep ((target - now + 999) / 1000);
+	}
+}
+
+static dc_status_t
+dc_replay_get_available (dc_iostream_t *abstract, size_t *value)
+{
+	dc_replay_t *replay = (dc_replay_t *) abstract;
+	dc_trace_record_t record;
+
+	if (replay->rd_size) {
+		*value = replay->rd_size;
+	} else {
+		size_t offset = replay->rd_offset;
+		if (dc_replay_next (replay, &offset, DC_TRACE_READ, DC_TRACE_READ, &record) == DC_STATUS_SUCCESS) {
+			*value = record.size;
+		} else {
+			*value = 0;
+		}
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_replay_poll (dc_iostream_t *abstract, int timeout)
+{
+	size_t available = 0;
+
+	UNUSED(timeout);
+
+	dc_replay_get_available (abstract, &available);
+
+	return available ? DC_STATUS_SUCCESS : DC_STATUS_TIMEOUT;
+}
+
+static dc_status_t
+dc_replay_read (dc_iostream_t *abstract, void *data, size_t size, size_t *actual)
+{
+	dc_replay_t *replay = (dc_replay_t *) abstract;
+	dc_trace_record_t record;
+
+	if (replay->rd_size == 0) {
+		if (dc_replay_next (replay, &replay->rd_offset, DC_TRACE_READ, DC_TRACE_READ, &record) != DC_STATUS_SUCCESS) {
+			*actual = 0;
+			return DC_STATUS_TIMEOUT;
+		}
+
+		dc_replay_wait (replay, record.timestamp);
+
+		if (record.size == 0) {
+			*actual = 0;
+			return record.status;
+		}
+
+		replay->rd_data = record.data;
+		replay->rd_size = record.size;
+		replay->rd_status = record.status;
+	}
+
+	size_t nbytes = size < replay->rd_size ? size : replay->rd_size;
+	memcpy (data, replay->rd_data, nbytes);
+	replay->rd_data += nbytes;
+	replay->rd_size -= nbytes;
+
+	*actual = nbytes;
+
+	// The original status is reported together with the last bytes.
+	return replay->rd_size ? DC_STATUS_SUCCESS : replay->rd_status;
+}
+
+static dc_status_t
+dc_replay_write (dc_iostream_t *abstract, const void *data, size_t size, size_t *actual)
+{
+	dc_replay_t *replay = (dc_replay_t *) abstract;
+	const unsigned char *p = (const unsigned char *) data;
+	dc_trace_record_t record;
+	size_t nbytes = 0;
+
+	while (nbytes < size) {
+		if (replay->wr_size == 0) {
+			if (dc_replay_next (replay, &replay->wr_offset, DC_TRACE_WRITE, DC_TRACE_WRITE, &record) != DC_STATUS_SUCCESS) {
+				ERROR (abstract->context, "Unexpected write beyond the end of the transcript.");
+				*actual = nbytes;
+				return DC_STATUS_PROTOCOL;
+			}
+
+			replay->wr_data = record.data;
+			replay->wr_size = record.size;
+			continue;
+		}
+
+		size_t n = size - nbytes;
+		if (n > replay->wr_size)
+			n = replay->wr_size;
+
+		if (memcmp (p + nbytes, replay->wr_data, n) != 0) {
+			ERROR (abstract->context, "Unexpected write data (offset %llu).", replay->wr_total);
+			HEXDUMP (abstract->context, DC_LOGLEVEL_ERROR, "Expected", replay->wr_data, n);
+			*actual = nbytes;
+			return DC_STATUS_PROTOCOL;
+		}
+
+		replay->wr_data += n;
+		replay->wr_size -= n;
+		replay->wr_total += n;
+		nbytes += n;
+	}
+
+	*actual = nbytes;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_replay_ioctl (dc_iostream_t *abstract, unsigned int request, void *data, size_t size)
+{
+	dc_replay_t *replay = (dc_replay_t *) abstract;
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_trace_record_t record;
+
+	if (DC_IOCTL_DIR(request) & DC_IOCTL_DIR_WRITE) {
+		if (dc_replay_next (replay, &replay->io_offset, DC_TRACE_IOCTL_WRITE, DC_TRACE_IOCTL_READ, &record) != DC_STATUS_SUCCESS ||
+			record.type != DC_TRACE_IOCTL_WRITE || record.request != request ||
+			record.size != size || memcmp (record.data, data, size) != 0) {
+			ERROR (abstract->context, "Unexpected ioctl request 0x%08x.", request);
+			return DC_STATUS_PROTOCOL;
+		}
+	}
+
+	if (DC_IOCTL_DIR(request) & DC_IOCTL_DIR_READ) {
+		if (dc_replay_next (replay, &replay->io_offset, DC_TRACE_IOCTL_READ, DC_TRACE_IOCTL_WRITE, &record) != DC_STATUS_SUCCESS ||
+			record.type != DC_TRACE_IOCTL_READ || record.request != request) {
+			ERROR (abstract->context, "Unexpected ioctl request 0x%08x.", request);
+			return DC_STATUS_PROTOCOL;
+		}
+
+		memcpy (data, record.data, record.size < size ? record.size : size);
+		status = record.status;
+	}
+
+	return status;
+}
+
+static dc_status_t
+dc_replay_sleep (dc_iostream_t *abstract, unsigned int milliseconds)
+{
+	dc_replay_t *replay = (dc_replay_t *) abstract;
+
+	if (replay->flags & DC_REPLAY_TIMING) {
+		if (dc_platform_sleep (milliseconds) != 0)
+			return DC_STATUS_IO;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+dc_replay_close (dc_iostream_t *abstract)
+{
+	dc_replay_t *replay = (dc_replay_t *) abstract;
+
+	dc_timer_free (replay->timer);
+	dc_buffer_free (replay->transcript);
+
+	return DC_STATUS_SUCCESS;
+}
@@ -30,6 +30,15 @@
 
 #define SZ_PACKET  254
 
+#define TIMEOUT       3000
+#define TIMEOUT_DRAIN 500
+
+// Number of block requests in flight during a download. Pipelining
+// mainly pays off over BLE, where the round-trip latency dominates.
+#define WINDOW_DEFAULT 1
+#define WINDOW_BLE     4
+#define WINDOW_MAX     16
+
 // SLIP special character codes
 #define END       0xC0
 #define ESC       0xDB
@@ -42,6 +51,8 @@ shearwater_common_setup (shearwater_common_device_t *device, dc_context_t *conte
 	dc_status_t status = DC_STATUS_SUCCESS;
 
 	device->iostream = iostream;
+	device->window = (dc_iostream_get_transport (iostream) == DC_TRANSPORT_BLE) ?
+		WINDOW_BLE : WINDOW_DEFAULT;
 
 	// Set the serial communication protocol (115200 8N1).
 	status = dc_iostream_configure (device->iostream, 115200, 8, DC_PARITY_NONE, DC_STOPBITS_ONE, DC_FLOWCONTROL_NONE);
@@ -51,7 +62,7 @@ shearwater_common_setup (shearwater_common_device_t *device, dc_context_t *conte
 	}
 
 	// Set the timeout for receiving data (3000ms).
-	status = dc_iostream_set_timeout (device->iostream, 3000);
+	status = dc_iostream_set_timeout (device->iostream, TIMEOUT);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to set the timeout.");
 		return status;
@@ -65,59 +76,100 @@ shearwater_common_setup (shearwater_common_device_t *device, dc_context_t *conte
 }
 
 
+dc_status_t
+shearwater_common_set_window (shearwater_common_device_t *device, unsigned int window)
+{
+	if (window < 1 || window > WINDOW_MAX)
+		return DC_STATUS_INVALIDARGS;
+
+	device->window = window;
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 static int
-shearwater_common_decompress_lre (unsigned char *data, unsigned int size, dc_buffer_t *buffer, unsigned int *isfinal)
+shearwater_common_decompress (const unsigned char data[], unsigned int size, dc_buffer_t *buffer, unsigned int *isfinal)
 {
-	// The RLE decompression algorithm does interpret the binary data as a
+	unsigned short symbols[SZ_PACKET * 8 / 9];
+	unsigned int nsymbols = 0;
+
+	// The LRE decompression algorithm does interpret the binary data as a
 	// stream of 9 bit values. Therefore, the total number of bits needs to be
 	// a multiple of 9 bits.
-	unsigned int nbits = size * 8;
-	if (nbits % 9 != 0)
+	if ((size * 8) % 9 != 0 || size > SZ_PACKET)
 		return -1;
 
+	// Extract the 9 bit values, and calculate the size of the expanded
+	// data. The 9th bit indicates whether the remaining 8 bits represent
+	// a run of zero bytes or not. If the bit is set, the value is not a
+	// run and doesn’t need expansion. If the bit is not set, the value
+	// contains the number of zero bytes in the run. A zero-length run
+	// indicates the end of the compressed stream.
+	unsigned long long bitbuffer = 0;
+	unsigned int nbits = 0;
+	unsigned int length = 0;
 	unsigned int offset = 0;
-	while (offset + 9 <= nbits) {
-		// Extract the 9 bit value.
-		unsigned int byte = offset / 8;
-		unsigned int bit  = offset % 8;
-		unsigned int shift = 16 - (bit + 9);
-		unsigned int value = (array_uint16_be (data + byte) >> shift) & 0x1FF;
-
-		// The 9th bit indicates whether the remaining 8 bits represent
-		// a run of zero bytes or not. If the bit is set, the value is
-		// not a run and doesn’t need expansion. If the bit is not set,
-		// the value contains the number of zero bytes in the run. A
-		// zero-length run indicates the end of the compressed stream.
-		if (value & 0x100) {
-			// Append the data byte directly.
-			unsigned char c = value & 0xFF;
-			if (!dc_buffer_append (buffer, &c, 1))
-				return -1;
-		} else if (value == 0) {
-			// Reached the end of the compressed stream.
-			if (isfinal)
-				*isfinal = 1;
-			break;
-		} else {
-			// Expand the run with zero bytes.
-			if (!dc_buffer_resize (buffer, dc_buffer_get_size (buffer) + value))
-				return -1;
+	while (offset < size || nbits >= 9) {
+		// Refill the bit buffer.
+		while (nbits <= 56 && offset < size) {
+			bitbuffer = (bitbuffer << 8) | data[offset++];
+			nbits += 8;
 		}
 
-		offset += 9;
+		while (nbits >= 9) {
+			nbits -= 9;
+			unsigned int value = (bitbuffer >> nbits) & 0x1FF;
+			if (value == 0) {
+				// Reached the end of the compressed stream.
+				if (isfinal)
+					*isfinal = 1;
+				goto expand;
+			}
+
+			symbols[nsymbols++] = value;
+			length += (value & 0x100) ? 1 : value;
+		}
 	}
 
-	return 0;
-}
+expand:
+	if (length == 0)
+		return 0;
 
+	// Expand the data directly into its final location. The new space is
+	// zero filled, so the zero runs only need to be written explicitly
+	// once the XOR pass kicks in.
+	size_t n = dc_buffer_get_size (buffer);
+	if (!dc_buffer_resize (buffer, n + length))
+		return -1;
 
-static int
-shearwater_common_decompress_xor (unsigned char *data, unsigned int size)
-{
-	// Each block of 32 bytes is XOR'ed (in-place) with the previous block,
-	// except for the first block, which is passed through unchanged.
-	for (unsigned int i = 32; i < size; ++i) {
-		data[i] ^= data[i - 32];
+	unsigned char *out = dc_buffer_get_data (buffer);
+
+	// Each block of 32 bytes is XOR'ed with the previous block, except for
+	// the first block, which is passed through unchanged. This is applied
+	// on the fly, while expanding the data.
+	for (unsigned int i = 0; i < nsymbols; ++i) {
+		unsigned int value = symbols[i];
+		if (value & 0x100) {
+			unsigned char c = value & 0xFF;
+			out[n] = (n >= 32) ? c ^ out[n - 32] : c;
+			n++;
+		} else {
+			// A run of zero bytes repeats the previous 32 bytes. Those
+			// are copied in chunks, which double in size with every
+			// iteration.
+			size_t end = n + value;
+			if (n < 32)
+				n = (end < 32) ? end : 32;
+			size_t src = n - 32;
+			while (n < end) {
+				size_t count = n - src;
+				if (count > end - n)
+					count = end - n;
+				memcpy (out + n, out + src, count);
+				n += count;
+			}
+		}
 	}
 
 	return 0;
@@ -317,15 +369,14 @@ done:
 }
 
 
-dc_status_t
-shearwater_common_transfer (shearwater_common_device_t *device, const unsigned char input[], unsigned int isize, unsigned char output[], unsigned int osize, unsigned int *actual)
+static dc_status_t
+shearwater_common_request (shearwater_common_device_t *device, const unsigned char input[], unsigned int isize)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	dc_device_t *abstract = (dc_device_t *) device;
 	unsigned char packet[SZ_PACKET + 4];
-	unsigned int n = 0;
 
-	if (isize > SZ_PACKET || osize > SZ_PACKET)
+	if (isize > SZ_PACKET)
 		return DC_STATUS_INVALIDARGS;
 
 	if (device_is_cancelled (abstract))
@@ -345,12 +396,20 @@ shearwater_common_transfer (shearwater_common_device_t *device, const unsigned c
 		return status;
 	}
 
-	// Return early if no response packet is requested.
-	if (osize == 0) {
-		if (actual)
-			*actual = 0;
-		return DC_STATUS_SUCCESS;
-	}
+	return DC_STATUS_SUCCESS;
+}
+
+
+static dc_status_t
+shearwater_common_response (shearwater_common_device_t *device, unsigned char output[], unsigned int osize, unsigned int *actual)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_device_t *abstract = (dc_device_t *) device;
+	unsigned char packet[SZ_PACKET + 4];
+	unsigned int n = 0;
+
+	if (osize > SZ_PACKET)
+		return DC_STATUS_INVALIDARGS;
 
 	// Receive the response packet.
 	status = shearwater_common_slip_read (device, packet, sizeof (packet), &n);
@@ -381,12 +440,40 @@ shearwater_common_transfer (shearwater_common_device_t *device, const unsigned c
 
 
 dc_status_t
-shearwater_common_download (shearwater_common_device_t *device, dc_buffer_t *buffer, unsigned int address, unsigned int size, unsigned int compression, dc_event_progress_t *progress)
+shearwater_common_transfer (shearwater_common_device_t *device, const unsigned char input[], unsigned int isize, unsigned char output[], unsigned int osize, unsigned int *actual)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	if (isize > SZ_PACKET || osize > SZ_PACKET)
+		return DC_STATUS_INVALIDARGS;
+
+	// Send the request packet.
+	status = shearwater_common_request (device, input, isize);
+	if (status != DC_STATUS_SUCCESS) {
+		return status;
+	}
+
+	// Return early if no response packet is requested.
+	if (osize == 0) {
+		if (actual)
+			*actual = 0;
+		return DC_STATUS_SUCCESS;
+	}
+
+	// Receive the response packet.
+	return shearwater_common_response (device, output, osize, actual);
+}
+
+
+static dc_status_t
+shearwater_common_download_window (shearwater_common_device_t *device, dc_buffer_t *buffer, unsigned int address, unsigned int size, unsigned int compression, unsigned int window, unsigned int *pipelined, dc_event_progress_t *progress)
 {
 	dc_device_t *abstract = (dc_device_t *) device;
 	dc_status_t rc = DC_STATUS_SUCCESS;
 	unsigned int n = 0;
 
+	*pipelined = 0;
+
 	unsigned char req_init[] = {
 		0x35,
 		(compression ? 0x10 : 0x00),
@@ -434,22 +521,53 @@ shearwater_common_download (shearwater_common_device_t *device, dc_buffer_t *buf
 		device_event_emit (abstract, DC_EVENT_PROGRESS, progress);
 	}
 
+	// Up to window block requests are kept in flight. The responses
+	// arrive in the same order as the requests, so they can be processed
+	// one by one. Because the block size is only known after the first
+	// response, and no more blocks should be requested than strictly
+	// necessary, the first block is always transferred on its own. A
+	// missing or out-of-sequence response while more than one request
+	// is outstanding is reported through the pipelined flag, such that
+	// the caller can retry without the window.
+	//
+	// With compression enabled, the end of the data is only known once
+	// the decompressor reaches it, and the requested size is merely an
+	// upper limit. Any additional request could ask for blocks past the
+	// end, so compressed data is always transferred one block at a time.
+	if (compression)
+		window = 1;
+
 	unsigned int done = 0;
-	unsigned char block = 1;
+	unsigned char block = 1, next = 1;
+	unsigned int inflight = 0, blocksize = 0;
 	unsigned int nbytes = 0;
 	while (nbytes < size && !done) {
-		// Transfer the block request.
-		req_block[1] = block;
-		rc = shearwater_common_transfer (device, req_block, sizeof (req_block), response, sizeof (response), &n);
+		// Send the block requests.
+		while (inflight == 0 ||
+			(inflight < window && blocksize && nbytes + inflight * blocksize < size)) {
+			req_block[1] = next;
+			rc = shearwater_common_request (device, req_block, sizeof (req_block));
+			if (rc != DC_STATUS_SUCCESS) {
+				return rc;
+			}
+			inflight++;
+			next++;
+		}
+
+		// Receive the block response.
+		rc = shearwater_common_response (device, response, sizeof (response), &n);
 		if (rc != DC_STATUS_SUCCESS) {
+			*pipelined = (inflight > 1);
 			return rc;
 		}
 
 		// Verify the block header.
 		if (n < 2 || response[0] != 0x76 || response[1] != block) {
 			ERROR (abstract->context, "Unexpected response packet.");
+			*pipelined = (inflight > 1);
 			return DC_STATUS_PROTOCOL;
 		}
+		inflight--;
 
 		// Verify the block length.
 		unsigned int length = n - 2;
@@ -466,8 +584,8 @@ shearwater_common_download (shearwater_common_device_t *device, dc_buffer_t *buf
 		}
 
 		if (compression) {
-			if (shearwater_common_decompress_lre (response + 2, length, buffer, &done) != 0) {
-				ERROR (abstract->context, "Decompression error (LRE phase).");
+			if (shearwater_common_decompress (response + 2, length, buffer, &done) != 0) {
+				ERROR (abstract->context, "Decompression error.");
 				return DC_STATUS_PROTOCOL;
 			}
 		} else {
@@ -477,17 +595,13 @@ shearwater_common_download (shearwater_common_device_t *device, dc_buffer_t *buf
 			}
 		}
 
+		if (blocksize == 0)
+			blocksize = length;
+
 		nbytes += length;
 		block++;
 	}
 
-	if (compression) {
-		if (shearwater_common_decompress_xor (dc_buffer_get_data (buffer), dc_buffer_get_size (buffer)) != 0) {
-			ERROR (abstract->context, "Decompression error (XOR phase).");
-			return DC_STATUS_PROTOCOL;
-		}
-	}
-
 	// Transfer the quit request.
 	rc = shearwater_common_transfer (device, req_quit, sizeof (req_quit), response, 2, &n);
 	if (rc != DC_STATUS_SUCCESS) {
@@ -511,6 +625,47 @@ shearwater_common_download (shearwater_common_device_t *device, dc_buffer_t *buf
 }
 
 
+dc_status_t
+shearwater_common_download (shearwater_common_device_t *device, dc_buffer_t *buffer, unsigned int address, unsigned int size, unsigned int compression, dc_event_progress_t *progress)
+{
+	dc_device_t *abstract = (dc_device_t *) device;
+	dc_status_t rc = DC_STATUS_SUCCESS;
+
+	unsigned int initial = progress ? progress->current : 0;
+	unsigned int pipelined = 0;
+
+	rc = shearwater_common_download_window (device, buffer, address, size, compression, device->window, &pipelined, progress);
+	if (pipelined && (rc == DC_STATUS_PROTOCOL || rc == DC_STATUS_TIMEOUT)) {
+		// Not all firmware versions accept multiple outstanding block
+		// requests. Fall back to stop-and-wait for the remainder of the
+		// session, and restart the transfer.
+		WARNING (abstract->context, "Pipelined download failed (%s). Falling back to stop-and-wait.",
+			rc == DC_STATUS_TIMEOUT ? "missing response" : "unexpected response");
+		device->window = 1;
+
+		dc_iostream_sleep (device->iostream, TIMEOUT_DRAIN);
+		dc_iostream_purge (device->iostream, DC_DIRECTION_ALL);
+
+		// End the failed transfer before starting a new one. The quit
+		// response is not verified, because a late block response may
+		// arrive in its place.
+		unsigned char req_quit[] = {0x37};
+		unsigned char response[SZ_PACKET];
+		shearwater_common_transfer (device, req_quit, sizeof (req_quit), response, sizeof (response), NULL);
+
+		dc_iostream_sleep (device->iostream, TIMEOUT_DRAIN);
+		dc_iostream_purge (device->iostream, DC_DIRECTION_ALL);
+
+		if (progress)
+			progress->current = initial;
+
+		rc = shearwater_common_download_window (device, buffer, address, size, compression, device->window, &pipelined, progress);
+	}
+
+	return rc;
+}
+
+
 dc_status_t
 shearwater_common_identifier (shearwater_common_device_t *device, dc_buffer_t *buffer, unsigned int id)
 {
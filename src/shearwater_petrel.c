@@ -129,6 +129,18 @@ shearwater_petrel_device_close (dc_device_t *abstract)
 }
 
 
+dc_status_t
+shearwater_petrel_device_set_window (dc_device_t *abstract, unsigned int window)
+{
+	shearwater_common_device_t *device = (shearwater_common_device_t *) abstract;
+
+	if (!ISINSTANCE (abstract))
+		return DC_STATUS_INVALIDARGS;
+
+	return shearwater_common_set_window (device, window);
+}
+
+
 static dc_status_t
 shearwater_petrel_device_set_fingerprint (dc_device_t *abstract, const unsigned char data[], unsigned int size)
 {
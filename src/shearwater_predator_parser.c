@@ -81,6 +81,9 @@
 
 #define UNDEFINED 0xFFFFFFFF
 
+#define HEADER  1
+#define PROFILE 2
+
 typedef struct shearwater_predator_parser_t shearwater_predator_parser_t;
 
 typedef struct shearwater_predator_gasmix_t {
@@ -126,30 +129,41 @@ struct shearwater_predator_parser_t {
 };
 
 static dc_status_t shearwater_predator_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t shearwater_predator_parser_reset (dc_parser_t *abstract);
 static dc_status_t shearwater_predator_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t shearwater_predator_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
+static dc_status_t shearwater_predator_parser_get_summary (dc_parser_t *abstract, dc_summary_t *summary);
 static dc_status_t shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
+static dc_status_t shearwater_predator_parser_samples_batch (dc_parser_t *abstract, dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata);
+static dc_status_t shearwater_predator_parser_destroy (dc_parser_t *abstract);
 
+static dc_status_t shearwater_predator_parser_cache_header (shearwater_predator_parser_t *parser);
 static dc_status_t shearwater_predator_parser_cache (shearwater_predator_parser_t *parser);
 
 static const dc_parser_vtable_t shearwater_predator_parser_vtable = {
 	sizeof(shearwater_predator_parser_t),
 	DC_FAMILY_SHEARWATER_PREDATOR,
 	shearwater_predator_parser_set_data, /* set_data */
+	shearwater_predator_parser_reset, /* reset */
 	shearwater_predator_parser_get_datetime, /* datetime */
 	shearwater_predator_parser_get_field, /* fields */
+	shearwater_predator_parser_get_summary, /* summary */
 	shearwater_predator_parser_samples_foreach, /* samples_foreach */
-	NULL /* destroy */
+	shearwater_predator_parser_samples_batch, /* samples_batch */
+	shearwater_predator_parser_destroy /* destroy */
 };
 
 static const dc_parser_vtable_t shearwater_petrel_parser_vtable = {
 	sizeof(shearwater_predator_parser_t),
 	DC_FAMILY_SHEARWATER_PETREL,
 	shearwater_predator_parser_set_data, /* set_data */
+	shearwater_predator_parser_reset, /* reset */
 	shearwater_predator_parser_get_datetime, /* datetime */
 	shearwater_predator_parser_get_field, /* fields */
+	shearwater_predator_parser_get_summary, /* summary */
 	shearwater_predator_parser_samples_foreach, /* samples_foreach */
-	NULL /* destroy */
+	shearwater_predator_parser_samples_batch, /* samples_batch */
+	shearwater_predator_parser_destroy /* destroy */
 };
 
 
@@ -230,6 +244,7 @@ shearwater_common_parser_create (dc_parser_t **out, dc_context_t *context, unsig
 	parser->density = 1025;
 	parser->atmospheric = ATM / (BAR / 1000);
 
+	memset(&parser->cache, 0, sizeof(parser->cache));
 	DC_ASSIGN_FIELD(parser->cache, DIVEMODE, DC_DIVEMODE_OC);
 
 	*out = (dc_parser_t *) parser;
@@ -253,7 +268,7 @@ shearwater_petrel_parser_create (dc_parser_t **out, dc_context_t *context, unsig
 
 
 static dc_status_t
-shearwater_predator_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+shearwater_predator_parser_reset (dc_parser_t *abstract)
 {
 	shearwater_predator_parser_t *parser = (shearwater_predator_parser_t *) abstract;
 
@@ -288,20 +303,38 @@ shearwater_predator_parser_set_data (dc_parser_t *abstract, const unsigned char
 	parser->density = 1025;
 	parser->atmospheric = ATM / (BAR / 1000);
 
+	dc_field_clear(&parser->cache);
 	DC_ASSIGN_FIELD(parser->cache, DIVEMODE, DC_DIVEMODE_OC);
 
 	return DC_STATUS_SUCCESS;
 }
 
 
+static dc_status_t
+shearwater_predator_parser_destroy (dc_parser_t *abstract)
+{
+	shearwater_predator_parser_t *parser = (shearwater_predator_parser_t *) abstract;
+
+	dc_field_free(&parser->cache);
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+shearwater_predator_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
+
 static dc_status_t
 shearwater_predator_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
 {
 	shearwater_predator_parser_t *parser = (shearwater_predator_parser_t *) abstract;
 	const unsigned char *data = abstract->data;
 
-	// Cache the parser data.
-	dc_status_t rc = shearwater_predator_parser_cache (parser);
+	// Cache the header data.
+	dc_status_t rc = shearwater_predator_parser_cache_header (parser);
 	if (rc != DC_STATUS_SUCCESS)
 		return rc;
 
@@ -395,16 +428,15 @@ add_battery_type(shearwater_predator_parser_t *parser, const unsigned char *data
 }
 
 static dc_status_t
-shearwater_predator_parser_cache (shearwater_predator_parser_t *parser)
+shearwater_predator_parser_cache_header (shearwater_predator_parser_t *parser)
 {
 	dc_parser_t *abstract = (dc_parser_t *) parser;
 	const unsigned char *data = parser->base.data;
 	unsigned int size = parser->base.size;
 
-	if (parser->cached) {
+	if (parser->cached >= HEADER) {
 		return DC_STATUS_SUCCESS;
 	}
-	memset(&parser->cache, 0, sizeof(parser->cache));
 
 	// Log versions before 6 weren't reliably stored in the data, but
 	// 6 is also the oldest version that we assume in our code
@@ -455,8 +487,112 @@ shearwater_predator_parser_cache (shearwater_predator_parser_t *parser)
 
 		// Log version
 		logversion = data[127];
+	} else {
+		for (unsigned int i = 0; i < NRECORDS; ++i) {
+			parser->opening[i] = UNDEFINED;
+			parser->closing[i] = UNDEFINED;
+		}
+		parser->final = UNDEFINED;
+
+		// The opening records are stored before the samples, and the
+		// closing and final records after them. Locate them from both
+		// ends, without walking the samples.
+		unsigned int offset = 0;
+		while (offset + parser->samplesize <= size) {
+			unsigned int type = data[offset];
+			if (type >= LOG_RECORD_OPENING_0 && type <= LOG_RECORD_OPENING_7) {
+				parser->opening[type - LOG_RECORD_OPENING_0] = offset;
+			} else if (!array_isequal (data + offset, parser->samplesize, 0x00)) {
+				break;
+			}
+			offset += parser->samplesize;
+		}
+
+		unsigned int end = size - size % parser->samplesize;
+		while (end > offset) {
+			unsigned int record = end - parser->samplesize;
+			unsigned int type = data[record];
+			if (type >= LOG_RECORD_CLOSING_0 && type <= LOG_RECORD_CLOSING_7) {
+				if (parser->closing[type - LOG_RECORD_CLOSING_0] == UNDEFINED)
+					parser->closing[type - LOG_RECORD_CLOSING_0] = record;
+			} else if (type == LOG_RECORD_FINAL) {
+				if (parser->final == UNDEFINED)
+					parser->final = record;
+			} else if (!array_isequal (data + record, parser->samplesize, 0x00)) {
+				break;
+			}
+			end = record;
+		}
+
+		// Fall back to scanning all the records when some of the
+		// required records are stored in between the samples.
+		unsigned int missing = 0;
+		for (unsigned int i = 0; i <= 4; ++i) {
+			if (parser->opening[i] == UNDEFINED || parser->closing[i] == UNDEFINED)
+				missing = 1;
+		}
+		for (offset = 0; missing && offset + parser->samplesize <= size; offset += parser->samplesize) {
+			unsigned int type = data[offset];
+			if (type >= LOG_RECORD_OPENING_0 && type <= LOG_RECORD_OPENING_7) {
+				parser->opening[type - LOG_RECORD_OPENING_0] = offset;
+			} else if (type >= LOG_RECORD_CLOSING_0 && type <= LOG_RECORD_CLOSING_7) {
+				parser->closing[type - LOG_RECORD_CLOSING_0] = offset;
+			} else if (type == LOG_RECORD_FINAL) {
+				parser->final = offset;
+			}
+		}
+	}
+
+	// Verify the required opening/closing records.
+	// At least in firmware v71 and newer, Petrel and Petrel 2 also use PNF,
+	// and there opening/closing record 5 (which contains AI information plus
+	// the sample interval) don't appear to exist - so don't mark them as required
+	for (unsigned int i = 0; i <= 4; ++i) {
+		if (parser->opening[i] == UNDEFINED || parser->closing[i] == UNDEFINED) {
+			ERROR (abstract->context, "Opening or closing record %u not found.", i);
+			return DC_STATUS_DATAFORMAT;
+		}
+	}
+
+	// Log version
+	if (pnf) {
+		logversion = data[parser->opening[4] + 16];
+	}
+
+	// Cache the data for later use.
+	parser->pnf = pnf;
+	parser->logversion = logversion;
+	parser->headersize = headersize;
+	parser->footersize = footersize;
+	parser->units = data[parser->opening[0] + 8];
+	parser->atmospheric = array_uint16_be (data + parser->opening[1] + (parser->pnf ? 16 : 47));
+	parser->density = array_uint16_be (data + parser->opening[3] + (parser->pnf ? 3 : 83));
+	parser->cached = HEADER;
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+shearwater_predator_parser_cache (shearwater_predator_parser_t *parser)
+{
+	dc_parser_t *abstract = (dc_parser_t *) parser;
+	const unsigned char *data = parser->base.data;
+	unsigned int size = parser->base.size;
+
+	if (parser->cached >= PROFILE) {
+		return DC_STATUS_SUCCESS;
 	}
 
+	// Cache the header data.
+	dc_status_t rc = shearwater_predator_parser_cache_header (parser);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	dc_field_clear(&parser->cache);
+
+	unsigned int pnf = parser->pnf;
+	unsigned int logversion = parser->logversion;
+
 	// Default dive mode.
 	dc_divemode_t mode = DC_DIVEMODE_OC;
 
@@ -466,8 +602,8 @@ shearwater_predator_parser_cache (shearwater_predator_parser_t *parser)
 	shearwater_predator_tank_t tank[NTANKS] = {0};
 	unsigned int o2_previous = 0, he_previous = 0;
 
-	unsigned int offset = headersize;
-	unsigned int length = size - footersize;
+	unsigned int offset = parser->headersize;
+	unsigned int length = size - parser->footersize;
 	while (offset + parser->samplesize <= length) {
 		// Ignore empty samples.
 		if (array_isequal (data + offset, parser->samplesize, 0x00)) {
@@ -542,36 +678,11 @@ shearwater_predator_parser_cache (shearwater_predator_parser_t *parser)
 		} else if (type == LOG_RECORD_FREEDIVE_SAMPLE) {
 			// Freedive record
 			mode = DC_DIVEMODE_FREEDIVE;
-		} else if (type >= LOG_RECORD_OPENING_0 && type <= LOG_RECORD_OPENING_7) {
-			// Opening record
-			parser->opening[type - LOG_RECORD_OPENING_0] = offset;
-
-			// Log version
-			if (type == LOG_RECORD_OPENING_4) {
-				logversion = data[offset + 16];
-			}
-		} else if (type >= LOG_RECORD_CLOSING_0 && type <= LOG_RECORD_CLOSING_7) {
-			// Closing record
-			parser->closing[type - LOG_RECORD_CLOSING_0] = offset;
-		} else if (type == LOG_RECORD_FINAL) {
-			// Final record
-			parser->final = offset;
 		}
 
 		offset += parser->samplesize;
 	}
 
-	// Verify the required opening/closing records.
-	// At least in firmware v71 and newer, Petrel and Petrel 2 also use PNF,
-	// and there opening/closing record 5 (which contains AI information plus
-	// the sample interval) don't appear to exist - so don't mark them as required
-	for (unsigned int i = 0; i <= 4; ++i) {
-		if (parser->opening[i] == UNDEFINED || parser->closing[i] == UNDEFINED) {
-			ERROR (abstract->context, "Opening or closing record %u not found.", i);
-			return DC_STATUS_DATAFORMAT;
-		}
-	}
-
 	dc_field_add_string_fmt(&parser->cache, "Logversion", "%d%s", logversion, pnf ? "(PNF)" : "");
 
 	// Cache sensor calibration for later use
@@ -611,10 +722,6 @@ shearwater_predator_parser_cache (shearwater_predator_parser_t *parser)
 	}
 
 	// Cache the data for later use.
-	parser->pnf = pnf;
-	parser->logversion = logversion;
-	parser->headersize = headersize;
-	parser->footersize = footersize;
 	parser->ngasmixes = ngasmixes;
 	for (unsigned int i = 0; i < ngasmixes; ++i) {
 		parser->gasmix[i] = gasmix[i];
@@ -629,10 +736,7 @@ shearwater_predator_parser_cache (shearwater_predator_parser_t *parser)
 			parser->tankidx[i] = UNDEFINED;
 		}
 	}
-	parser->units = data[parser->opening[0] + 8];
-	parser->atmospheric = array_uint16_be (data + parser->opening[1] + (parser->pnf ? 16 : 47));
-	parser->density = array_uint16_be (data + parser->opening[3] + (parser->pnf ? 3 : 83));
-	parser->cached = 1;
+	parser->cached = PROFILE;
 
 	DC_ASSIGN_FIELD(parser->cache, DIVEMODE, mode);
 
@@ -648,17 +752,22 @@ shearwater_predator_parser_cache (shearwater_predator_parser_t *parser)
 	return DC_STATUS_SUCCESS;
 }
 
+/*
+ * Get a field value. Only the header data needs to be cached, except for
+ * the gas mixes, tanks, dive mode and strings, which are only available
+ * once the profile is cached too.
+ */
 static dc_status_t
-shearwater_predator_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
+shearwater_predator_parser_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
 {
 	shearwater_predator_parser_t *parser = (shearwater_predator_parser_t *) abstract;
 
 	const unsigned char *data = abstract->data;
 
-	// Cache the parser data.
-	dc_status_t rc = shearwater_predator_parser_cache (parser);
-	if (rc != DC_STATUS_SUCCESS)
-		return rc;
+	if (parser->cached < PROFILE &&
+		type != DC_FIELD_DIVETIME && type != DC_FIELD_MAXDEPTH &&
+		type != DC_FIELD_SALINITY && type != DC_FIELD_ATMOSPHERIC)
+		return DC_STATUS_UNSUPPORTED;
 
 	dc_gasmix_t *gasmix = (dc_gasmix_t *) value;
 	dc_tank_t *tank = (dc_tank_t *) value;
@@ -722,6 +831,102 @@ shearwater_predator_parser_get_field (dc_parser_t *abstract, dc_field_type_t typ
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+shearwater_predator_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
+{
+	shearwater_predator_parser_t *parser = (shearwater_predator_parser_t *) abstract;
+
+	// Cache the parser data.
+	dc_status_t rc = shearwater_predator_parser_cache (parser);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	return shearwater_predator_parser_field (abstract, type, flags, value);
+}
+
+
+static dc_status_t
+shearwater_predator_parser_get_summary (dc_parser_t *abstract, dc_summary_t *summary)
+{
+	shearwater_predator_parser_t *parser = (shearwater_predator_parser_t *) abstract;
+
+	// Cache the header data.
+	dc_status_t rc = shearwater_predator_parser_cache_header (parser);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	return dc_parser_fill_summary (abstract, shearwater_predator_parser_field, summary);
+}
+
+
+static dc_status_t
+shearwater_predator_parser_interval (shearwater_predator_parser_t *parser, unsigned int *interval)
+{
+	const unsigned char *data = parser->base.data;
+
+	*interval = 10;
+	if (parser->pnf && parser->logversion >= 9 && parser->opening[5] != UNDEFINED) {
+		unsigned int value = array_uint16_be (data + parser->opening[5] + 23);
+		if (value % 1000 != 0) {
+			ERROR (parser->base.context, "Unsupported sample interval (%u ms).", value);
+			return DC_STATUS_DATAFORMAT;
+		}
+		*interval = value / 1000;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * Decode the values of a dive sample record. The pointer points to the
+ * record contents, after the record type for the PNF format.
+ */
+static double
+shearwater_predator_sample_depth (shearwater_predator_parser_t *parser, const unsigned char *record)
+{
+	// Depth (1/10 m or ft).
+	unsigned int depth = array_uint16_be (record);
+	if (parser->units == IMPERIAL)
+		return depth * FEET / 10.0;
+	else
+		return depth / 10.0;
+}
+
+static double
+shearwater_predator_sample_temperature (shearwater_predator_parser_t *parser, const unsigned char *record)
+{
+	// Temperature (°C or °F).
+	int temperature = (signed char) record[13];
+	if (temperature < 0) {
+		// Fix negative temperatures.
+		temperature += 102;
+		if (temperature > 0) {
+			temperature = 0;
+		}
+	}
+	if (parser->units == IMPERIAL)
+		return (temperature - 32.0) * (5.0 / 9.0);
+	else
+		return temperature;
+}
+
+static void
+shearwater_predator_sample_deco (shearwater_predator_parser_t *parser, const unsigned char *record, unsigned int *type, unsigned int *time, double *depth)
+{
+	// Deco stop / NDL.
+	unsigned int decostop = array_uint16_be (record + 2);
+	if (decostop) {
+		*type = DC_DECO_DECOSTOP;
+		if (parser->units == IMPERIAL)
+			*depth = decostop * FEET;
+		else
+			*depth = decostop;
+	} else {
+		*type = DC_DECO_NDL;
+		*depth = 0.0;
+	}
+	*time = record[9] * 60;
+}
 
 static dc_status_t
 shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
@@ -741,15 +946,10 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 
 	// Sample interval.
 	unsigned int time = 0;
-	unsigned int interval = 10;
-	if (parser->pnf && parser->logversion >= 9 && parser->opening[5] != UNDEFINED) {
-		interval = array_uint16_be (data + parser->opening[5] + 23);
-		if (interval % 1000 != 0) {
-			ERROR (abstract->context, "Unsupported sample interval (%u ms).", interval);
-			return DC_STATUS_DATAFORMAT;
-		}
-		interval /= 1000;
-	}
+	unsigned int interval = 0;
+	rc = shearwater_predator_parser_interval (parser, &interval);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
 
 	unsigned int pnf = parser->pnf;
 	unsigned int offset = parser->headersize;
@@ -776,27 +976,12 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 			sample.time = time;
 			if (callback) callback (DC_SAMPLE_TIME, sample, userdata);
 
-			// Depth (1/10 m or ft).
-			unsigned int depth = array_uint16_be (data + pnf + offset);
-			if (parser->units == IMPERIAL)
-				sample.depth = depth * FEET / 10.0;
-			else
-				sample.depth = depth / 10.0;
+			// Depth.
+			sample.depth = shearwater_predator_sample_depth (parser, data + offset + pnf);
 			if (callback) callback (DC_SAMPLE_DEPTH, sample, userdata);
 
-			// Temperature (°C or °F).
-			int temperature = (signed char) data[offset + pnf + 13];
-			if (temperature < 0) {
-				// Fix negative temperatures.
-				temperature += 102;
-				if (temperature > 0) {
-					temperature = 0;
-				}
-			}
-			if (parser->units == IMPERIAL)
-				sample.temperature = (temperature - 32.0) * (5.0 / 9.0);
-			else
-				sample.temperature = temperature;
+			// Temperature.
+			sample.temperature = shearwater_predator_sample_temperature (parser, data + offset + pnf);
 			if (callback) callback (DC_SAMPLE_TEMPERATURE, sample, userdata);
 
 			// Status flags.
@@ -857,18 +1042,8 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 			}
 
 			// Deco stop / NDL.
-			unsigned int decostop = array_uint16_be (data + offset + pnf + 2);
-			if (decostop) {
-				sample.deco.type = DC_DECO_DECOSTOP;
-				if (parser->units == IMPERIAL)
-					sample.deco.depth = decostop * FEET;
-				else
-					sample.deco.depth = decostop;
-			} else {
-				sample.deco.type = DC_DECO_NDL;
-				sample.deco.depth = 0.0;
-			}
-			sample.deco.time = data[offset + pnf + 9] * 60;
+			shearwater_predator_sample_deco (parser, data + offset + pnf,
+				&sample.deco.type, &sample.deco.time, &sample.deco.depth);
 			if (callback) callback (DC_SAMPLE_DECO, sample, userdata);
 
 			// for logversion 7 and newer (introduced for Perdix AI)
@@ -960,3 +1135,189 @@ shearwater_predator_parser_samples_foreach (dc_parser_t *abstract, dc_sample_cal
 
 	return DC_STATUS_SUCCESS;
 }
+
+
+/*
+ * Store the samples directly in the columns of the batch. The record
+ * walk mirrors shearwater_predator_parser_samples_foreach, but skips the
+ * sample types without a column.
+ */
+static dc_status_t
+shearwater_predator_parser_samples_batch (dc_parser_t *abstract, dc_sample_batch_t *batch, dc_sample_batch_callback_t callback, void *userdata)
+{
+	shearwater_predator_parser_t *parser = (shearwater_predator_parser_t *) abstract;
+
+	const unsigned char *data = abstract->data;
+	unsigned int size = abstract->size;
+	unsigned int mask = abstract->samplemask;
+	dc_sample_batch_writer_t writer;
+
+	// Cache the parser data.
+	dc_status_t rc = shearwater_predator_parser_cache (parser);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	// Previous gas mix.
+	unsigned int o2_previous = 0, he_previous = 0;
+
+	// Sample interval.
+	unsigned int time = 0;
+	unsigned int interval = 0;
+	rc = shearwater_predator_parser_interval (parser, &interval);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	dc_sample_batch_init (&writer, abstract->context, batch, callback, userdata);
+
+	unsigned int pnf = parser->pnf;
+	unsigned int offset = parser->headersize;
+	unsigned int length = size - parser->footersize;
+	while (offset + parser->samplesize <= length) {
+		unsigned int row = 0;
+
+		// Ignore empty samples.
+		if (array_isequal (data + offset, parser->samplesize, 0x00)) {
+			offset += parser->samplesize;
+			continue;
+		}
+
+		// Get the record type.
+		unsigned int type = pnf ? data[offset] : LOG_RECORD_DIVE_SAMPLE;
+
+		// stop parsing if we see the end block
+		if (type == LOG_RECORD_FINAL && data[offset + 1] == 0xFD)
+			break;
+
+		if (type == LOG_RECORD_DIVE_SAMPLE) {
+			const unsigned char *record = data + offset + pnf;
+
+			time += interval;
+			if (DC_SAMPLE_WANTED (mask, DC_SAMPLE_TIME)) {
+				row = dc_sample_batch_next (&writer);
+				if (batch->time)
+					batch->time[row] = time;
+			}
+
+			if (DC_SAMPLE_WANTED (mask, DC_SAMPLE_DEPTH)) {
+				row = dc_sample_batch_row (&writer);
+				if (batch->depth)
+					batch->depth[row] = shearwater_predator_sample_depth (parser, record);
+			}
+
+			if (DC_SAMPLE_WANTED (mask, DC_SAMPLE_TEMPERATURE)) {
+				row = dc_sample_batch_row (&writer);
+				if (batch->temperature)
+					batch->temperature[row] = shearwater_predator_sample_temperature (parser, record);
+			}
+
+			// PPO2 (only the last calibrated sensor ends up in the column).
+			unsigned int status = record[11];
+			if ((status & OC) == 0 && (status & PPO2_EXTERNAL) == 0 &&
+				DC_SAMPLE_WANTED (mask, DC_SAMPLE_PPO2)) {
+				unsigned int nsensors = 0;
+				double ppo2 = 0.0;
+				if (!parser->calibrated) {
+					ppo2 = record[6] / 100.0;
+					nsensors++;
+				} else {
+					const unsigned int idx[3] = {12, 14, 15};
+					for (unsigned int i = 0; i < 3; ++i) {
+						if (parser->calibrated & (1 << i)) {
+							ppo2 = record[idx[i]] * parser->calibration[i];
+							nsensors++;
+						}
+					}
+				}
+				if (nsensors) {
+					row = dc_sample_batch_row (&writer);
+					if (batch->ppo2)
+						batch->ppo2[row] = ppo2;
+				}
+			}
+
+			// Gaschange.
+			unsigned int o2 = record[7];
+			unsigned int he = record[8];
+			if (o2 != o2_previous || he != he_previous) {
+				unsigned int idx = shearwater_predator_find_gasmix (parser, o2, he);
+				if (idx >= parser->ngasmixes) {
+					ERROR (abstract->context, "Invalid gas mix.");
+					return DC_STATUS_DATAFORMAT;
+				}
+				o2_previous = o2;
+				he_previous = he;
+			}
+
+			if (DC_SAMPLE_WANTED (mask, DC_SAMPLE_DECO)) {
+				row = dc_sample_batch_row (&writer);
+				if (batch->deco) {
+					shearwater_predator_sample_deco (parser, record,
+						&batch->deco[row].type, &batch->deco[row].time, &batch->deco[row].depth);
+				}
+			}
+
+			// Tank pressure (see above for the special codes).
+			if (parser->logversion >= 7 && DC_SAMPLE_WANTED (mask, DC_SAMPLE_PRESSURE)) {
+				const unsigned int idx[NTANKS] = {27, 19};
+				for (unsigned int i = 0; i < NTANKS; ++i) {
+					unsigned int pressure = array_uint16_be (record + idx[i]);
+					if (pressure < 0xFFF0) {
+						unsigned int tank = parser->tankidx[i];
+						row = dc_sample_batch_row (&writer);
+						if (batch->pressure && tank < batch->ntanks)
+							batch->pressure[row * batch->ntanks + tank] = (pressure & 0x0FFF) * 2 * PSI / BAR;
+					}
+				}
+			}
+		} else if (type == LOG_RECORD_FREEDIVE_SAMPLE) {
+			for (unsigned int i = 0; i < 4; ++i) {
+				unsigned int idx = offset + i * SZ_SAMPLE_FREEDIVE;
+
+				// Ignore empty samples.
+				if (array_isequal (data + idx, SZ_SAMPLE_FREEDIVE, 0x00)) {
+					break;
+				}
+
+				time += interval;
+				if (DC_SAMPLE_WANTED (mask, DC_SAMPLE_TIME)) {
+					row = dc_sample_batch_next (&writer);
+					if (batch->time)
+						batch->time[row] = time;
+				}
+
+				// Depth (absolute pressure in millibar)
+				if (DC_SAMPLE_WANTED (mask, DC_SAMPLE_DEPTH)) {
+					unsigned int depth = array_uint16_be (data + idx + 1);
+					row = dc_sample_batch_row (&writer);
+					if (batch->depth)
+						batch->depth[row] = (depth - parser->atmospheric) * (BAR / 1000.0) / (parser->density * GRAVITY);
+				}
+
+				// Temperature (1/10 °C).
+				if (DC_SAMPLE_WANTED (mask, DC_SAMPLE_TEMPERATURE)) {
+					int temperature = (signed short) array_uint16_be (data + idx + 3);
+					row = dc_sample_batch_row (&writer);
+					if (batch->temperature)
+						batch->temperature[row] = temperature / 10.0;
+				}
+			}
+		} else if (type == LOG_RECORD_INFO_EVENT) {
+			unsigned int event = data[offset + 1];
+			unsigned int w2 = array_uint32_be (data + offset + 12);
+
+			if (event == INFO_EVENT_TAG_LOG && DC_SAMPLE_WANTED (mask, DC_SAMPLE_EVENT)) {
+				dc_sample_event_t *bookmark = dc_sample_batch_event (&writer);
+				if (bookmark) {
+					bookmark->type = SAMPLE_EVENT_BOOKMARK;
+					bookmark->value = w2;
+				}
+			}
+		}
+
+		offset += parser->samplesize;
+	}
+
+	dc_sample_batch_flush (&writer);
+
+	return DC_STATUS_SUCCESS;
+}
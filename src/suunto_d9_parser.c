@@ -95,6 +95,7 @@ typedef struct sample_info_t {
 } sample_info_t;
 
 static dc_status_t suunto_d9_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t suunto_d9_parser_reset (dc_parser_t *abstract);
 static dc_status_t suunto_d9_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t suunto_d9_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t suunto_d9_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -103,9 +104,12 @@ static const dc_parser_vtable_t suunto_d9_parser_vtable = {
 	sizeof(suunto_d9_parser_t),
 	DC_FAMILY_SUUNTO_D9,
 	suunto_d9_parser_set_data, /* set_data */
+	suunto_d9_parser_reset, /* reset */
 	suunto_d9_parser_get_datetime, /* datetime */
 	suunto_d9_parser_get_field, /* fields */
+	NULL, /* summary */
 	suunto_d9_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -286,7 +290,7 @@ suunto_d9_parser_create (dc_parser_t **out, dc_context_t *context, unsigned int
 
 
 static dc_status_t
-suunto_d9_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+suunto_d9_parser_reset (dc_parser_t *abstract)
 {
 	suunto_d9_parser_t *parser = (suunto_d9_parser_t *) abstract;
 
@@ -306,6 +310,12 @@ suunto_d9_parser_set_data (dc_parser_t *abstract, const unsigned char *data, uns
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+suunto_d9_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
 
 static dc_status_t
 suunto_d9_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
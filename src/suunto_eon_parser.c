@@ -44,6 +44,7 @@ struct suunto_eon_parser_t {
 };
 
 static dc_status_t suunto_eon_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t suunto_eon_parser_reset (dc_parser_t *abstract);
 static dc_status_t suunto_eon_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t suunto_eon_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t suunto_eon_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -52,9 +53,12 @@ static const dc_parser_vtable_t suunto_eon_parser_vtable = {
 	sizeof(suunto_eon_parser_t),
 	DC_FAMILY_SUUNTO_EON,
 	suunto_eon_parser_set_data, /* set_data */
+	suunto_eon_parser_reset, /* reset */
 	suunto_eon_parser_get_datetime, /* datetime */
 	suunto_eon_parser_get_field, /* fields */
+	NULL, /* summary */
 	suunto_eon_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -138,7 +142,7 @@ suunto_eon_parser_create (dc_parser_t **out, dc_context_t *context, int spyder)
 
 
 static dc_status_t
-suunto_eon_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+suunto_eon_parser_reset (dc_parser_t *abstract)
 {
 	suunto_eon_parser_t *parser = (suunto_eon_parser_t *) abstract;
 
@@ -152,6 +156,12 @@ suunto_eon_parser_set_data (dc_parser_t *abstract, const unsigned char *data, un
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+suunto_eon_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
 
 static dc_status_t
 suunto_eon_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
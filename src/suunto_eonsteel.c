@@ -39,6 +39,10 @@ typedef struct suunto_eonsteel_device_t {
 	unsigned int model;
 	unsigned int magic;
 	unsigned short seq;
+	unsigned int window;
+	// Bytes of a BLE packet after the end of the last HDLC frame.
+	unsigned char hdlc[20];
+	unsigned int hdlc_offset, hdlc_length;
 	unsigned char version[0x30];
 	unsigned char fingerprint[4];
 } suunto_eonsteel_device_t;
@@ -48,12 +52,18 @@ typedef struct suunto_eonsteel_device_t {
 #define DIRTYPE_DIR  0x0002
 
 struct directory_entry {
-	struct directory_entry *next;
+	unsigned int time;
 	int type;
 	int namelen;
 	char name[1];
 };
 
+// A list of files in the dive directory
+struct file_list {
+	struct directory_entry **entry;
+	unsigned int count, allocated;
+};
+
 // EON Steel command numbers and other magic field values
 #define CMD_INIT	0x0000
 #define INIT_MAGIC	0x0001
@@ -80,6 +90,17 @@ struct directory_entry {
 #define MAXDATA_SIZE 2048
 #define CRC_SIZE    4
 
+// File reads start with the chunk size that is known to work, and
+// grow up to the largest one that fits in a reply (minus the 8 byte
+// offset and size fields), unless the device answers with less.
+#define READ_CHUNK_MIN 1024
+#define READ_CHUNK_MAX (MAXDATA_SIZE - 8)
+
+// Number of file read requests kept in flight. If the device does
+// not keep up, the download falls back to one request at a time.
+#define WINDOW_DEFAULT 4
+#define WINDOW_MAX     8
+
 // HDLC special characters
 #define END     0x7E
 #define ESC     0x7D
@@ -103,13 +124,29 @@ static const dc_device_vtable_t suunto_eonsteel_device_vtable = {
 
 static const char dive_directory[] = "0:/dives";
 
-static void file_list_free (struct directory_entry *de)
+static void file_list_free (struct file_list *list)
+{
+	for (unsigned int i = 0; i < list->count; ++i)
+		free (list->entry[i]);
+	free (list->entry);
+
+	list->entry = NULL;
+	list->count = list->allocated = 0;
+}
+
+static int file_list_append (struct file_list *list, struct directory_entry *entry)
 {
-	while (de) {
-		struct directory_entry *next = de->next;
-		free (de);
-		de = next;
+	if (list->count == list->allocated) {
+		unsigned int allocated = list->allocated ? list->allocated * 2 : 64;
+		struct directory_entry **array = (struct directory_entry **) realloc (list->entry, allocated * sizeof (*array));
+		if (array == NULL)
+			return -1;
+		list->entry = array;
+		list->allocated = allocated;
 	}
+
+	list->entry[list->count++] = entry;
+	return 0;
 }
 
 static struct directory_entry *alloc_dirent(int type, int len, const char *name)
@@ -118,7 +155,7 @@ static struct directory_entry *alloc_dirent(int type, int len, const char *name)
 
 	res = (struct directory_entry *) malloc(offsetof(struct directory_entry, name) + len + 1);
 	if (res) {
-		res->next = NULL;
+		res->time = 0;
 		res->type = type;
 		res->namelen = len;
 		memcpy(res->name, name, len);
@@ -209,22 +246,28 @@ static dc_status_t
 suunto_eonsteel_hdlc_read (suunto_eonsteel_device_t *device, unsigned char data[], size_t size, size_t *actual)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
-	unsigned char buffer[20];
 	unsigned int initialized = 0;
 	unsigned int escaped = 0;
 	size_t nbytes = 0;
 
 	while (1) {
-		// Read a single data packet.
-		size_t transferred = 0;
-		status = dc_iostream_read(device->iostream, buffer, sizeof(buffer), &transferred);
-		if (status != DC_STATUS_SUCCESS) {
-			ERROR(device->base.context, "Failed to receive the packet.");
-			return status;
+		// Read a single data packet, unless some data is left over
+		// from the previous one. With several requests in flight,
+		// that is the start of the next frame.
+		if (device->hdlc_length == 0) {
+			size_t transferred = 0;
+			status = dc_iostream_read(device->iostream, device->hdlc, sizeof(device->hdlc), &transferred);
+			if (status != DC_STATUS_SUCCESS) {
+				ERROR(device->base.context, "Failed to receive the packet.");
+				return status;
+			}
+			device->hdlc_offset = 0;
+			device->hdlc_length = transferred;
 		}
 
-		for (size_t i = 0; i < transferred; ++i) {
-			unsigned char c = buffer[i];
+		while (device->hdlc_length) {
+			unsigned char c = device->hdlc[device->hdlc_offset++];
+			device->hdlc_length--;
 
 			if (c == END) {
 				if (escaped) {
@@ -430,11 +473,11 @@ suunto_eonsteel_send(suunto_eonsteel_device_t *device,
 }
 
 /*
- * Send a command, receive a reply
+ * Receive the reply to a command
  *
  * This carefully checks the data fields in the reply for a match
- * against the command, and then only returns the actual reply
- * data itself.
+ * against the command and its sequence number, and then only returns
+ * the actual reply data itself.
  *
  * Also note that receive() function itself will have removed the
  * per-packet handshake bytes, so unlike the send() function, this
@@ -443,9 +486,8 @@ suunto_eonsteel_send(suunto_eonsteel_device_t *device,
  * send() side. The offsets are the same in the actual raw packet.
  */
 static dc_status_t
-suunto_eonsteel_transfer(suunto_eonsteel_device_t *device,
-	unsigned short cmd,
-	const unsigned char data[], unsigned int size,
+suunto_eonsteel_receive(suunto_eonsteel_device_t *device,
+	unsigned short cmd, unsigned short expected,
 	unsigned char answer[], unsigned int asize,
 	unsigned int *actual)
 {
@@ -453,11 +495,6 @@ suunto_eonsteel_transfer(suunto_eonsteel_device_t *device,
 	unsigned char header[HEADER_SIZE + MAXDATA_SIZE];
 	unsigned int len = 0;
 
-	// Send the command.
-	rc = suunto_eonsteel_send(device, cmd, data, size);
-	if (rc != DC_STATUS_SUCCESS)
-		return rc;
-
 	if (dc_iostream_get_transport(device->iostream) == DC_TRANSPORT_BLE) {
 		// Receive the entire data packet.
 		rc = suunto_eonsteel_receive_ble(device, header, sizeof(header), &len);
@@ -495,8 +532,8 @@ suunto_eonsteel_transfer(suunto_eonsteel_device_t *device,
 	}
 
 	// Verify the sequence number.
-	if (seq != device->seq) {
-		ERROR(device->base.context, "Unexpected sequence number (received %04x, expected %04x).", seq, device->seq);
+	if (seq != expected) {
+		ERROR(device->base.context, "Unexpected sequence number (received %04x, expected %04x).", seq, expected);
 		return DC_STATUS_PROTOCOL;
 	}
 
@@ -541,64 +578,99 @@ suunto_eonsteel_transfer(suunto_eonsteel_device_t *device,
 		device->magic = (magic & 0xffff0000) | 0x0005;
 	}
 
-	// Increment the sequence number.
-	device->seq++;
-
 	if (actual)
 		*actual = nbytes;
 
 	return DC_STATUS_SUCCESS;
 }
 
+/*
+ * Send a command, receive a reply
+ */
 static dc_status_t
-read_file(suunto_eonsteel_device_t *eon, const char *filename, dc_buffer_t *buf)
+suunto_eonsteel_transfer(suunto_eonsteel_device_t *device,
+	unsigned short cmd,
+	const unsigned char data[], unsigned int size,
+	unsigned char answer[], unsigned int asize,
+	unsigned int *actual)
 {
 	dc_status_t rc = DC_STATUS_SUCCESS;
-	unsigned char result[2560];
-	unsigned char cmdbuf[64];
-	unsigned int size, offset, len;
-	unsigned int n = 0;
 
-	memset(cmdbuf, 0, sizeof(cmdbuf));
-	len = strlen(filename) + 1;
-	if (len + 4 > sizeof(cmdbuf)) {
-		ERROR(eon->base.context, "too long filename: %s", filename);
-		return DC_STATUS_PROTOCOL;
-	}
-	memcpy(cmdbuf+4, filename, len);
-	rc = suunto_eonsteel_transfer(eon, CMD_FILE_OPEN,
-		cmdbuf, len + 4, result, sizeof(result), &n);
-	if (rc != DC_STATUS_SUCCESS) {
-		ERROR(eon->base.context, "unable to look up %s", filename);
+	// Send the command.
+	rc = suunto_eonsteel_send(device, cmd, data, size);
+	if (rc != DC_STATUS_SUCCESS)
 		return rc;
-	}
-	HEXDUMP (eon->base.context, DC_LOGLEVEL_DEBUG, "lookup", result, n);
 
-	rc = suunto_eonsteel_transfer(eon, CMD_FILE_STAT,
-		NULL, 0, result, sizeof(result), &n);
-	if (rc != DC_STATUS_SUCCESS) {
-		ERROR(eon->base.context, "unable to stat %s", filename);
+	// Receive the reply.
+	rc = suunto_eonsteel_receive(device, cmd, device->seq, answer, asize, actual);
+	if (rc != DC_STATUS_SUCCESS)
 		return rc;
-	}
-	HEXDUMP (eon->base.context, DC_LOGLEVEL_DEBUG, "stat", result, n);
 
-	size = array_uint32_le(result+4);
-	offset = 0;
-
-	while (size > 0) {
-		unsigned int ask, got, at;
-
-		ask = size;
-		if (ask > 1024)
-			ask = 1024;
-		put_le32(1234, cmdbuf+0);	// Not file offset, after all
-		put_le32(ask, cmdbuf+4);	// Size of read
-		rc = suunto_eonsteel_transfer(eon, CMD_FILE_READ,
-			cmdbuf, 8, result, sizeof(result), &n);
+	// Increment the sequence number.
+	device->seq++;
+
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * Read the contents of an open file
+ *
+ * Up to window read requests are kept in flight. Each one gets its
+ * own sequence number, and the replies arrive in the same order as
+ * the requests. No more is requested than the remaining file size.
+ *
+ * A window of one is the fallback for devices that fail the faster
+ * reads, so it also keeps the chunk size that is known to work.
+ */
+static dc_status_t
+read_file_data(suunto_eonsteel_device_t *eon, const char *filename, unsigned int size, unsigned int window, dc_buffer_t *buf)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	unsigned char result[2560];
+	unsigned char cmdbuf[8];
+	unsigned short seq[WINDOW_MAX];
+	unsigned int ask[WINDOW_MAX];
+	unsigned int head = 0, count = 0;
+	unsigned int requested = 0;
+	unsigned int chunk = READ_CHUNK_MIN, capped = (window == 1);
+	unsigned int offset = 0, eof = 0;
+
+	while (count || (!eof && size > requested)) {
+		unsigned int n = 0, at, got, asked;
+
+		// Keep the window full.
+		while (!eof && count < window && size > requested) {
+			unsigned int slot = (head + count) % WINDOW_MAX;
+
+			ask[slot] = size - requested;
+			if (ask[slot] > chunk)
+				ask[slot] = chunk;
+			put_le32(1234, cmdbuf+0);	// Not file offset, after all
+			put_le32(ask[slot], cmdbuf+4);	// Size of read
+			seq[slot] = eon->seq;
+			rc = suunto_eonsteel_send(eon, CMD_FILE_READ, cmdbuf, 8);
+			if (rc != DC_STATUS_SUCCESS) {
+				ERROR(eon->base.context, "unable to read %s", filename);
+				return rc;
+			}
+			eon->seq++;
+
+			requested += ask[slot];
+			count++;
+		}
+
+		// Receive the oldest reply.
+		rc = suunto_eonsteel_receive(eon, CMD_FILE_READ, seq[head],
+			result, sizeof(result), &n);
 		if (rc != DC_STATUS_SUCCESS) {
 			ERROR(eon->base.context, "unable to read %s", filename);
 			return rc;
 		}
+		asked = ask[head];
+		head = (head + 1) % WINDOW_MAX;
+		requested -= asked;
+		count--;
+
 		if (n < 8) {
 			ERROR(eon->base.context, "got short read reply for %s", filename);
 			return DC_STATUS_PROTOCOL;
@@ -611,10 +683,16 @@ read_file(suunto_eonsteel_device_t *eon, const char *filename, dc_buffer_t *buf)
 			return DC_STATUS_PROTOCOL;
 		}
 
+		// Replies to requests beyond the end are just drained.
+		if (eof)
+			continue;
+
 		// Number of bytes actually read
 		got = array_uint32_le(result+4);
-		if (!got)
-			break;
+		if (!got) {
+			eof = 1;
+			continue;
+		}
 		if (n < 8 + got) {
 			ERROR(eon->base.context, "odd read size reply for offset %d of file %s", offset, filename);
 			return DC_STATUS_PROTOCOL;
@@ -628,7 +706,61 @@ read_file(suunto_eonsteel_device_t *eon, const char *filename, dc_buffer_t *buf)
 		}
 		offset += got;
 		size -= got;
+
+		// A short read in the middle of the file is the most
+		// the device hands out at once. Otherwise ask for more.
+		if (got < asked) {
+			if (size && got < chunk) {
+				chunk = got;
+				capped = 1;
+			}
+		} else if (!capped && asked == chunk && chunk < READ_CHUNK_MAX) {
+			chunk *= 2;
+			if (chunk > READ_CHUNK_MAX)
+				chunk = READ_CHUNK_MAX;
+		}
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+read_file_window(suunto_eonsteel_device_t *eon, const char *filename, unsigned int window, dc_buffer_t *buf)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	unsigned char result[2560];
+	unsigned char cmdbuf[64];
+	unsigned int size, len;
+	unsigned int n = 0;
+
+	memset(cmdbuf, 0, sizeof(cmdbuf));
+	len = strlen(filename) + 1;
+	if (len + 4 > sizeof(cmdbuf)) {
+		ERROR(eon->base.context, "too long filename: %s", filename);
+		return DC_STATUS_PROTOCOL;
 	}
+	memcpy(cmdbuf+4, filename, len);
+	rc = suunto_eonsteel_transfer(eon, CMD_FILE_OPEN,
+		cmdbuf, len + 4, result, sizeof(result), &n);
+	if (rc != DC_STATUS_SUCCESS) {
+		ERROR(eon->base.context, "unable to look up %s", filename);
+		return rc;
+	}
+	HEXDUMP (eon->base.context, DC_LOGLEVEL_DEBUG, "lookup", result, n);
+
+	rc = suunto_eonsteel_transfer(eon, CMD_FILE_STAT,
+		NULL, 0, result, sizeof(result), &n);
+	if (rc != DC_STATUS_SUCCESS) {
+		ERROR(eon->base.context, "unable to stat %s", filename);
+		return rc;
+	}
+	HEXDUMP (eon->base.context, DC_LOGLEVEL_DEBUG, "stat", result, n);
+
+	size = array_uint32_le(result+4);
+
+	rc = read_file_data(eon, filename, size, window, buf);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
 
 	rc = suunto_eonsteel_transfer(eon, CMD_FILE_CLOSE,
 		NULL, 0, result, sizeof(result), &n);
@@ -641,41 +773,116 @@ read_file(suunto_eonsteel_device_t *eon, const char *filename, dc_buffer_t *buf)
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+read_file(suunto_eonsteel_device_t *eon, const char *filename, dc_buffer_t *buf)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+	unsigned char result[2560];
+	size_t length = dc_buffer_get_size(buf);
+
+	rc = read_file_window(eon, filename, eon->window, buf);
+	if ((rc != DC_STATUS_PROTOCOL && rc != DC_STATUS_TIMEOUT) || eon->window == 1)
+		return rc;
+
+	// The device did not cope with several reads in flight or the
+	// larger chunks. Throw away whatever is still on its way, and
+	// start over with one request of the original chunk size at a
+	// time for the rest of the session.
+	WARNING(eon->base.context, "Pipelined read of %s failed, retrying without pipelining.", filename);
+	eon->window = 1;
+
+	dc_platform_sleep(100);
+	dc_iostream_purge(eon->iostream, DC_DIRECTION_INPUT);
+	eon->hdlc_offset = 0;
+	eon->hdlc_length = 0;
+	dc_buffer_resize(buf, length);
+
+	// Close the half read file, if it is still open.
+	suunto_eonsteel_transfer(eon, CMD_FILE_CLOSE, NULL, 0, result, sizeof(result), NULL);
+
+	return read_file_window(eon, filename, eon->window, buf);
+}
+
 /*
- * Insert a directory entry in the sorted list, most recent entry
- * first.
+ * Order the directory entries with the most recent entry first.
  *
- * The directory entry names are the timestamps as hex, so ordering
- * in alphabetical order ends up also ordering in date order!
+ * The directory entry names are the timestamps as hex, so the
+ * timestamps parsed from them give the date order.
  */
-static struct directory_entry *insert_dirent(struct directory_entry *entry, struct directory_entry *list)
+static int dirent_compare(const void *a, const void *b)
 {
-	struct directory_entry **pos = &list, *next;
+	const struct directory_entry *x = *(const struct directory_entry * const *) a;
+	const struct directory_entry *y = *(const struct directory_entry * const *) b;
 
-	while ((next = *pos) != NULL) {
-		/* Is this bigger (more recent) than the next entry? We're good! */
-		if (strcmp(entry->name, next->name) > 0)
-			break;
-		pos = &next->next;
+	if (x->time == y->time)
+		return strcmp(y->name, x->name);
+	return x->time < y->time ? 1 : -1;
+}
+
+/*
+ * Order the directory entries by name, in reverse alphabetical order.
+ * This is the order in which the files without a valid timestamp were
+ * visited along with the dives before.
+ */
+static int dirent_compare_name(const void *a, const void *b)
+{
+	const struct directory_entry *x = *(const struct directory_entry * const *) a;
+	const struct directory_entry *y = *(const struct directory_entry * const *) b;
+
+	return strcmp(y->name, x->name);
+}
+
+/*
+ * Find the dive with the given timestamp in the sorted list. All the
+ * dives before it are newer. If it is not there, all dives are new.
+ */
+static unsigned int file_list_find(const struct file_list *list, unsigned int time)
+{
+	unsigned int lo = 0, hi = list->count;
+
+	while (lo < hi) {
+		unsigned int mid = lo + (hi - lo) / 2;
+		if (list->entry[mid]->time > time)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
-	entry->next = next;
-	*pos = entry;
 
-	return list;
+	if (lo < list->count && list->entry[lo]->time == time)
+		return lo;
+
+	return list->count;
 }
 
 /*
- * NOTE! This will create the list of dirent's in reverse order,
- * with the last dirent first. That's intentional: for dives,
- * we will want to look up the last dive first.
+ * Report the files without a valid timestamp that come before the
+ * given entry in name order, or all remaining ones without an entry.
+ * As before, files past the point where the download stops (the
+ * fingerprint dive, or a cancelled download) are not reported.
  */
-static struct directory_entry *parse_dirent(suunto_eonsteel_device_t *eon, int nr, const unsigned char *p, unsigned int len, struct directory_entry *list)
+static void file_list_report(suunto_eonsteel_device_t *eon, const struct file_list *invalid, unsigned int *next, const struct directory_entry *limit, dc_status_t *status)
+{
+	while (*next < invalid->count &&
+		(limit == NULL || strcmp(invalid->entry[*next]->name, limit->name) > 0)) {
+		ERROR(eon->base.context, "unexpected dive file name %s", invalid->entry[*next]->name);
+		dc_status_set_error(status, DC_STATUS_PROTOCOL);
+		(*next)++;
+	}
+}
+
+/*
+ * Add the files to the list of dives, or to the list of invalid files
+ * if the name has no timestamp.
+ */
+static void parse_dirent(suunto_eonsteel_device_t *eon, int nr, const unsigned char *p, unsigned int len, struct file_list *list, struct file_list *invalid)
 {
 	while (len > 8) {
 		unsigned int type = array_uint32_le(p);
 		unsigned int namelen = array_uint32_le(p+4);
 		const unsigned char *name = p+8;
 		struct directory_entry *entry;
+		unsigned int time = 0;
+		int valid;
 
 		if (namelen + 8 + 1 > len || name[namelen] != 0) {
 			ERROR(eon->base.context, "corrupt dirent entry");
@@ -685,21 +892,28 @@ static struct directory_entry *parse_dirent(suunto_eonsteel_device_t *eon, int n
 
 		p += 8 + namelen + 1;
 		len -= 8 + namelen + 1;
+
+		/* Ignore subdirectories in the dive directory */
+		if (type != DIRTYPE_FILE)
+			continue;
+
+		valid = sscanf((const char *) name, "%x.LOG", &time) == 1;
+
 		entry = alloc_dirent(type, namelen, (const char *) name);
-		if (!entry) {
+		if (!entry || file_list_append(valid ? list : invalid, entry) < 0) {
 			ERROR(eon->base.context, "out of memory");
+			free(entry);
 			break;
 		}
-		list = insert_dirent(entry, list);
+		if (valid)
+			entry->time = time;
 	}
-	return list;
 }
 
 static dc_status_t
-get_file_list(suunto_eonsteel_device_t *eon, struct directory_entry **res)
+get_file_list(suunto_eonsteel_device_t *eon, struct file_list *list, struct file_list *invalid)
 {
 	dc_status_t rc = DC_STATUS_SUCCESS;
-	struct directory_entry *de = NULL;
 	unsigned char cmd[64];
 	unsigned char result[2048];
 	unsigned int n = 0;
@@ -723,19 +937,21 @@ get_file_list(suunto_eonsteel_device_t *eon, struct directory_entry **res)
 			NULL, 0, result, sizeof(result), &n);
 		if (rc != DC_STATUS_SUCCESS) {
 			ERROR(eon->base.context, "readdir failed");
-			file_list_free(de);
+			file_list_free(list);
+			file_list_free(invalid);
 			return rc;
 		}
 		if (n < 8) {
 			ERROR(eon->base.context, "short readdir result");
-			file_list_free(de);
+			file_list_free(list);
+			file_list_free(invalid);
 			return DC_STATUS_PROTOCOL;
 		}
 		nr = array_uint32_le(result);
 		last = array_uint32_le(result+4);
 		HEXDUMP(eon->base.context, DC_LOGLEVEL_DEBUG, "dir packet", result, 8);
 
-		de = parse_dirent(eon, nr, result+8, n-8, de);
+		parse_dirent(eon, nr, result+8, n-8, list, invalid);
 		if (last)
 			break;
 	}
@@ -744,28 +960,19 @@ get_file_list(suunto_eonsteel_device_t *eon, struct directory_entry **res)
 		NULL, 0, result, sizeof(result), NULL);
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR(eon->base.context, "dir close failed");
-		file_list_free(de);
+		file_list_free(list);
+		file_list_free(invalid);
 		return rc;
 	}
 
-	*res = de;
+	if (list->count)
+		qsort(list->entry, list->count, sizeof(*list->entry), dirent_compare);
+	if (invalid->count)
+		qsort(invalid->entry, invalid->count, sizeof(*invalid->entry), dirent_compare_name);
 
 	return DC_STATUS_SUCCESS;
 }
 
-static int
-count_file_list(struct directory_entry *list)
-{
-	int count = 0;
-
-	while (list) {
-		count++;
-		list = list->next;
-	}
-
-	return count;
-}
-
 dc_status_t
 suunto_eonsteel_device_open(dc_device_t **out, dc_context_t *context, dc_iostream_t *iostream, unsigned int model)
 {
@@ -784,6 +991,9 @@ suunto_eonsteel_device_open(dc_device_t **out, dc_context_t *context, dc_iostrea
 	eon->model = model;
 	eon->magic = INIT_MAGIC;
 	eon->seq = INIT_SEQ;
+	eon->window = WINDOW_DEFAULT;
+	eon->hdlc_offset = 0;
+	eon->hdlc_length = 0;
 	memset (eon->version, 0, sizeof (eon->version));
 	memset (eon->fingerprint, 0, sizeof (eon->fingerprint));
 
@@ -831,12 +1041,13 @@ suunto_eonsteel_device_foreach(dc_device_t *abstract, dc_dive_callback_t callbac
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	dc_status_t rc = DC_STATUS_SUCCESS;
-	int skip = 0;
-	struct directory_entry *de;
+	struct file_list list = {NULL, 0, 0};
+	struct file_list invalid = {NULL, 0, 0};
+	const struct directory_entry *last = NULL;
+	unsigned int ndives = 0, ninvalid = 0, i = 0;
 	suunto_eonsteel_device_t *eon = (suunto_eonsteel_device_t *) abstract;
 	dc_buffer_t *file;
 	char pathname[64];
-	unsigned int time;
 	dc_event_progress_t progress = EVENT_PROGRESS_INITIALIZER;
 
 	// Emit a device info event.
@@ -846,63 +1057,53 @@ suunto_eonsteel_device_foreach(dc_device_t *abstract, dc_dive_callback_t callbac
 	devinfo.serial = array_convert_str2num(eon->version + 0x10, 16);
 	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
 
-	rc = get_file_list(eon, &de);
+	rc = get_file_list(eon, &list, &invalid);
 	if (rc != DC_STATUS_SUCCESS)
 		return rc;
 
-	if (de == NULL) {
-		return DC_STATUS_SUCCESS;
+	// Only the dives newer than the fingerprint dive get downloaded.
+	ndives = file_list_find(&list, array_uint32_le(eon->fingerprint));
+	if (ndives < list.count)
+		last = list.entry[ndives];
+	if (ndives == 0) {
+		file_list_report(eon, &invalid, &ninvalid, last, &status);
+		file_list_free(&list);
+		file_list_free(&invalid);
+		return status;
 	}
 
 	file = dc_buffer_new (16384);
 	if (file == NULL) {
 		ERROR (abstract->context, "Insufficient buffer space available.");
-		file_list_free(de);
+		file_list_free(&list);
+		file_list_free(&invalid);
 		return DC_STATUS_NOMEMORY;
 	}
 
-	progress.maximum = count_file_list(de);
+	progress.maximum = ndives;
 	progress.current = 0;
 	device_event_emit(abstract, DC_EVENT_PROGRESS, &progress);
 
-	while (de) {
+	for (i = 0; i < ndives; ++i) {
+		const struct directory_entry *de = list.entry[i];
 		int len;
-		struct directory_entry *next = de->next;
 		unsigned char buf[4];
 		const unsigned char *data = NULL;
 		unsigned int size = 0;
 
 		if (device_is_cancelled(abstract)) {
 			dc_status_set_error(&status, DC_STATUS_CANCELLED);
-			skip = 1;
-		}
-
-		switch (de->type) {
-		case DIRTYPE_DIR:
-			/* Ignore subdirectories in the dive directory */
 			break;
-		case DIRTYPE_FILE:
-			if (skip)
-				break;
-
-			if (sscanf(de->name, "%x.LOG", &time) != 1) {
-				dc_status_set_error(&status, DC_STATUS_PROTOCOL);
-				break;
-			}
-
-			put_le32(time, buf);
+		}
 
-			if (memcmp (buf, eon->fingerprint, sizeof (eon->fingerprint)) == 0) {
-				skip = 1;
-				break;
-			}
+		file_list_report(eon, &invalid, &ninvalid, de, &status);
 
-			len = snprintf(pathname, sizeof(pathname), "%s/%s", dive_directory, de->name);
-			if (len < 0 || (unsigned int) len >= sizeof(pathname)) {
-				dc_status_set_error(&status, DC_STATUS_PROTOCOL);
-				break;
-			}
+		put_le32(de->time, buf);
 
+		len = snprintf(pathname, sizeof(pathname), "%s/%s", dive_directory, de->name);
+		if (len < 0 || (unsigned int) len >= sizeof(pathname)) {
+			dc_status_set_error(&status, DC_STATUS_PROTOCOL);
+		} else {
 			// Reset the membuffer, put the 4-byte length at the head.
 			dc_buffer_clear(file);
 			dc_buffer_append(file, buf, 4);
@@ -911,21 +1112,22 @@ suunto_eonsteel_device_foreach(dc_device_t *abstract, dc_dive_callback_t callbac
 			rc = read_file(eon, pathname, file);
 			if (rc != DC_STATUS_SUCCESS) {
 				dc_status_set_error(&status, rc);
-				break;
-			}
-
-			data = dc_buffer_get_data(file);
-			size = dc_buffer_get_size(file);
+			} else {
+				data = dc_buffer_get_data(file);
+				size = dc_buffer_get_size(file);
 
-			if (callback && !callback(data, size, data, sizeof(eon->fingerprint), userdata))
-				skip = 1;
+				if (callback && !callback(data, size, data, sizeof(eon->fingerprint), userdata))
+					break;
+			}
 		}
+
 		progress.current++;
 		device_event_emit(abstract, DC_EVENT_PROGRESS, &progress);
-
-		free(de);
-		de = next;
 	}
+	if (i == ndives)
+		file_list_report(eon, &invalid, &ninvalid, last, &status);
+	file_list_free(&list);
+	file_list_free(&invalid);
 	dc_buffer_free(file);
 
 	return status;
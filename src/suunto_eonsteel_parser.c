@@ -30,6 +30,7 @@
 #include "array.h"
 #include "platform.h"
 #include "field-cache.h"
+#include "thread.h"
 
 #define C_ARRAY_SIZE(a) (sizeof(a) / sizeof(*(a)))
 
@@ -64,10 +65,21 @@ enum eon_sample {
 
 #define EON_MAX_GROUP 16
 
+struct desc_entry;
+
 struct type_desc {
-	char *desc, *format, *mod;
+	const char *desc, *format, *mod;
 	unsigned int size;
 	enum eon_sample type[EON_MAX_GROUP];
+
+	// Enumeration names, indexed by value
+	const char **enums;
+	unsigned int nenums;
+
+	// The shared descriptor behind this type. It is kept
+	// across dives, because the next dive from the same
+	// firmware will almost certainly declare it again.
+	struct desc_entry *entry;
 };
 
 #define MAXTYPE 512
@@ -76,6 +88,14 @@ typedef struct suunto_eonsteel_parser_t {
 	dc_parser_t base;
 	struct type_desc type_desc[MAXTYPE];
 	struct dc_field_cache cache;
+
+	// Setpoints, and the tank info that goes with the cached gas mixes
+	double lowsetpoint;
+	double highsetpoint;
+	double customsetpoint;
+	dc_tankinfo_t tankinfo[MAXGASES];
+	double tanksize[MAXGASES];
+	double tankworkingpressure[MAXGASES];
 } suunto_eonsteel_parser_t;
 
 typedef int (*eon_data_cb_t)(unsigned short type, const struct type_desc *desc, const unsigned char *data, unsigned int len, void *user);
@@ -238,97 +258,350 @@ static int fill_in_group_details(suunto_eonsteel_parser_t *eon, struct type_desc
  * which all start with "sml.DeviceLog.Samples" (for the
  * base types) or are "GRP" types that are a group of said
  * types and are a set of numbers.
+ *
+ * Every dive file declares all of its type descriptors again, but
+ * they are the same for all dives from the same firmware. So the
+ * parsed descriptors are kept in a cache that is shared by all the
+ * parsers, keyed by the descriptor text.
+ *
+ * Entries are reference counted by the parsers using them. Entries
+ * nobody uses any more are only dropped when the cache fills up, so
+ * that they survive a parser being created for every dive.
  */
-static int fill_in_desc_details(suunto_eonsteel_parser_t *eon, struct type_desc *desc)
+#define DESC_HASH_SIZE 256
+#define DESC_CACHE_MAX 1024
+
+struct desc_entry {
+	struct desc_entry *next;
+	unsigned int hash, refcount;
+
+	// The parsed descriptor. Group descriptors refer to the
+	// other types of their dive, and are resolved per dive.
+	struct type_desc desc;
+
+	// The descriptor text, followed by a copy split into
+	// the NUL terminated strings the descriptor points to.
+	unsigned int len;
+	char text[];
+};
+
+static struct {
+	dc_atomic_t lock;
+	unsigned int count;
+	struct desc_entry *hash[DESC_HASH_SIZE];
+} desc_cache;
+
+static void desc_cache_lock(void)
 {
-	if (!desc->desc)
-		return 0;
+	// Only held for a hash lookup, so just spin.
+	while (dc_atomic_exchange(&desc_cache.lock, 1))
+		;
+}
 
-	if (isdigit(desc->desc[0]))
-		return fill_in_group_details(eon, desc);
+static void desc_cache_unlock(void)
+{
+	dc_atomic_store(&desc_cache.lock, 0);
+}
 
-	desc->size = lookup_descriptor_size(eon, desc);
-	desc->type[0] = lookup_descriptor_type(eon, desc);
-	return 0;
+static unsigned int desc_hash(const char *text, unsigned int len)
+{
+	// FNV-1a
+	unsigned int hash = 2166136261u;
+
+	for (unsigned int i = 0; i < len; ++i) {
+		hash ^= (unsigned char) text[i];
+		hash *= 16777619u;
+	}
+	return hash;
 }
 
-static void
-desc_free (struct type_desc desc[], unsigned int count)
+// Drop all the unused entries. Called with the lock held.
+static void desc_cache_trim(void)
 {
-	for (unsigned int i = 0; i < count; ++i) {
-		free(desc[i].desc);
-		free(desc[i].format);
-		free(desc[i].mod);
+	for (unsigned int i = 0; i < DESC_HASH_SIZE; ++i) {
+		struct desc_entry **pp = desc_cache.hash + i, *entry;
+
+		while ((entry = *pp) != NULL) {
+			if (entry->refcount) {
+				pp = &entry->next;
+				continue;
+			}
+			*pp = entry->next;
+			desc_cache.count--;
+			free(entry->desc.enums);
+			free(entry);
+		}
 	}
 }
 
-static int record_type(suunto_eonsteel_parser_t *eon, unsigned short type, const char *name, int namelen)
+/*
+ * Split up an enumeration into a table of names indexed by value.
+ *
+ * Enumerations have the enum values in the "format" string,
+ * and all start with "enum:" followed by a comma-separated list
+ * of enumeration values and strings. Example:
+ *
+ * "enum:0=NoFly Time,1=Depth,2=Surface Time,3=..."
+ *
+ * The list is walked twice: first to size the table and the
+ * names, and then to fill them in.
+ */
+static int parse_enum(struct type_desc *desc)
 {
-	struct type_desc desc;
-	const char *next;
+	const char *format = desc->format;
+	const char **table = NULL;
+	char *names = NULL;
+	unsigned int count = 0;
+	size_t bytes = 0;
+
+	if (!format || strncmp(format, "enum:", 5))
+		return 0;
 
-	memset(&desc, 0, sizeof(desc));
+	for (int pass = 0; pass < 2; pass++) {
+		const char *str = format + 5;
+		unsigned char c;
+
+		while ((c = *str) != 0) {
+			unsigned char n;
+			const char *begin, *end;
+
+			str++;
+			if (!isdigit(c))
+				continue;
+			n = c - '0';
+
+			// We only handle one or two digits
+			if (isdigit(*str)) {
+				n = n*10 + *str - '0';
+				str++;
+			}
+
+			begin = end = str;
+			while ((c = *str) != 0) {
+				str++;
+				if (c == ',')
+					break;
+				end = str;
+			}
+
+			// Verify that it has the 'n=string' format and skip the equals sign
+			if (*begin != '=')
+				continue;
+			begin++;
+
+			if (pass == 0) {
+				if (n >= count)
+					count = n + 1;
+				bytes += end - begin + 1;
+				continue;
+			}
+
+			// The first one wins
+			if (table[n])
+				continue;
+
+			memcpy(names, begin, end-begin);
+			names[end-begin] = 0;
+			table[n] = names;
+			names += end - begin + 1;
+		}
+
+		if (pass == 0) {
+			if (!count)
+				return 0;
+			table = (const char **) malloc(count * sizeof(*table) + bytes);
+			if (!table)
+				return -1;
+			memset(table, 0, count * sizeof(*table));
+			names = (char *) (table + count);
+		}
+	}
+
+	desc->enums = table;
+	desc->nenums = count;
+	return 0;
+}
+
+static struct desc_entry *desc_entry_new(suunto_eonsteel_parser_t *eon, const char *text, unsigned int len)
+{
+	struct desc_entry *entry;
+	char *name, *next;
+
+	entry = (struct desc_entry *) malloc(sizeof(*entry) + 2 * (len + 1));
+	if (!entry) {
+		ERROR(eon->base.context, "out of memory");
+		return NULL;
+	}
+	memset(entry, 0, sizeof(*entry));
+	entry->len = len;
+	memcpy(entry->text, text, len);
+	entry->text[len] = 0;
+
+	name = entry->text + len + 1;
+	memcpy(name, entry->text, len + 1);
 	do {
-		int len;
-		char *p;
+		int linelen;
 
 		next = strchr(name, '\n');
 		if (next) {
-			len = next - name;
-			next++;
-		} else {
-			len = strlen(name);
-			if (!len)
-				break;
+			*next++ = 0;
+		} else if (!*name) {
+			break;
 		}
+		linelen = strlen(name);
 
-		if (len < 5 || name[0] != '<' || name[4] != '>') {
-			ERROR(eon->base.context, "Unexpected type description: %.*s", len, name);
-			return -1;
+		if (linelen < 5 || name[0] != '<' || name[4] != '>') {
+			ERROR(eon->base.context, "Unexpected type description: %s", name);
+			free(entry);
+			return NULL;
 		}
-		p = (char *) malloc(len-4);
-		if (!p) {
-			ERROR(eon->base.context, "out of memory");
-			desc_free(&desc, 1);
-			return -1;
-		}
-		memcpy(p, name+5, len-5);
-		p[len-5] = 0;
 
 		// PTH, GRP, FRM, MOD
 		switch (name[1]) {
 		case 'P':
 		case 'G':
-			desc.desc = p;
+			entry->desc.desc = name + 5;
 			break;
 		case 'F':
-			desc.format = p;
+			entry->desc.format = name + 5;
 			break;
 		case 'M':
-			desc.mod = p;
+			entry->desc.mod = name + 5;
 			break;
 		default:
-			ERROR(eon->base.context, "Unknown type descriptor: %.*s", len, name);
-			desc_free(&desc, 1);
-			free(p);
-			return -1;
+			ERROR(eon->base.context, "Unknown type descriptor: %s", name);
+			free(entry);
+			return NULL;
 		}
 	} while ((name = next) != NULL);
 
+	if (entry->desc.desc && !isdigit(entry->desc.desc[0])) {
+		entry->desc.size = lookup_descriptor_size(eon, &entry->desc);
+		entry->desc.type[0] = lookup_descriptor_type(eon, &entry->desc);
+	}
+
+	if (parse_enum(&entry->desc) < 0) {
+		ERROR(eon->base.context, "out of memory");
+		free(entry);
+		return NULL;
+	}
+
+	return entry;
+}
+
+// Find an entry and take a reference. Called with the lock held.
+static struct desc_entry *desc_cache_find(struct desc_entry *bucket, unsigned int hash, const char *text, unsigned int len)
+{
+	struct desc_entry *entry;
+
+	for (entry = bucket; entry; entry = entry->next) {
+		if (entry->hash == hash && entry->len == len && !memcmp(entry->text, text, len)) {
+			entry->refcount++;
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+static struct desc_entry *desc_cache_get(suunto_eonsteel_parser_t *eon, const char *text, unsigned int len)
+{
+	unsigned int hash = desc_hash(text, len);
+	struct desc_entry *entry, *found, **bucket = desc_cache.hash + hash % DESC_HASH_SIZE;
+
+	desc_cache_lock();
+	found = desc_cache_find(*bucket, hash, text, len);
+	desc_cache_unlock();
+	if (found)
+		return found;
+
+	// Parse it without holding the lock
+	entry = desc_entry_new(eon, text, len);
+	if (!entry)
+		return NULL;
+	entry->hash = hash;
+	entry->refcount = 1;
+
+	// Another parser may have added it in the meantime
+	desc_cache_lock();
+	found = desc_cache_find(*bucket, hash, text, len);
+	if (!found) {
+		if (desc_cache.count >= DESC_CACHE_MAX)
+			desc_cache_trim();
+		entry->next = *bucket;
+		*bucket = entry;
+		desc_cache.count++;
+	}
+	desc_cache_unlock();
+
+	if (found) {
+		free(entry->desc.enums);
+		free(entry);
+		return found;
+	}
+
+	return entry;
+}
+
+static void desc_cache_put(struct desc_entry *entry)
+{
+	desc_cache_lock();
+	entry->refcount--;
+	desc_cache_unlock();
+}
+
+static void
+desc_clear (struct type_desc desc[], unsigned int count)
+{
+	for (unsigned int i = 0; i < count; ++i) {
+		struct desc_entry *entry = desc[i].entry;
+		memset(desc + i, 0, sizeof(desc[i]));
+		desc[i].entry = entry;
+	}
+}
+
+static void
+desc_free (struct type_desc desc[], unsigned int count)
+{
+	for (unsigned int i = 0; i < count; ++i) {
+		if (desc[i].entry)
+			desc_cache_put(desc[i].entry);
+	}
+	memset(desc, 0, count * sizeof(*desc));
+}
+
+static int record_type(suunto_eonsteel_parser_t *eon, unsigned short type, const char *name, int namelen)
+{
+	struct type_desc *desc;
+	struct desc_entry *entry;
+	unsigned int len;
+
+	if (namelen <= 0)
+		return -1;
+	len = strnlen(name, namelen);
+
 	if (type >= MAXTYPE) {
-		ERROR(eon->base.context, "Type out of range (%04x: '%s' '%s' '%s')",
-			type,
-			desc.desc ? desc.desc : "",
-			desc.format ? desc.format : "",
-			desc.mod ? desc.mod : "");
-		desc_free(&desc, 1);
+		ERROR(eon->base.context, "Type out of range (%04x: '%.*s')", type, len, name);
 		return -1;
 	}
+	desc = eon->type_desc + type;
+
+	// Most likely the same descriptor as in the last dive
+	entry = desc->entry;
+	if (!entry || entry->len != len || memcmp(entry->text, name, len)) {
+		entry = desc_cache_get(eon, name, len);
+		if (!entry)
+			return -1;
+		if (desc->entry)
+			desc_cache_put(desc->entry);
+	}
+
+	*desc = entry->desc;
+	desc->entry = entry;
 
-	fill_in_desc_details(eon, &desc);
+	// Groups refer to the other types of this dive
+	if (desc->desc && isdigit(desc->desc[0]))
+		fill_in_group_details(eon, desc);
 
-	desc_free(eon->type_desc + type, 1);
-	eon->type_desc[type] = desc;
 	return 0;
 }
 
@@ -353,6 +626,10 @@ static int traverse_entry(suunto_eonsteel_parser_t *eon, const unsigned char *p,
 	}
 
 	// Two bytes of 'type' followed by the name/descriptor, followed by the data
+	if (textlen < 3 || textlen > one_past_end - name) {
+		HEXDUMP(eon->base.context, DC_LOGLEVEL_DEBUG, "bad", p, 8);
+		return -1;
+	}
 	data = name + textlen;
 	id = array_uint16_le(name);
 	name += 2;
@@ -428,9 +705,10 @@ struct sample_data {
 	suunto_eonsteel_parser_t *eon;
 	dc_sample_callback_t callback;
 	void *userdata;
+	unsigned int mask;
 	unsigned int time;
-	char *state_type, *notify_type;
-	char *warning_type, *alarm_type;
+	const char *state_type, *notify_type;
+	const char *warning_type, *alarm_type;
 
 	/* We gather up deco and cylinder pressure information */
 	int gasnr;
@@ -582,67 +860,15 @@ static void sample_gas_switch_event(struct sample_data *info, unsigned short idx
 }
 
 /*
- * Look up the string from an enumeration.
- *
- * Enumerations have the enum values in the "format" string,
- * and all start with "enum:" followed by a comma-separated list
- * of enumeration values and strings. Example:
- *
- * "enum:0=NoFly Time,1=Depth,2=Surface Time,3=..."
+ * Look up the string from an enumeration. The names belong to the
+ * shared descriptor, so they don't need to be freed.
  */
-static char *lookup_enum(const struct type_desc *desc, unsigned char value)
+static const char *lookup_enum(const struct type_desc *desc, unsigned char value)
 {
-	const char *str = desc->format;
-	unsigned char c;
-
-	if (!str)
-		return NULL;
-	if (strncmp(str, "enum:", 5))
+	if (value >= desc->nenums)
 		return NULL;
-	str += 5;
 
-	while ((c = *str) != 0) {
-		unsigned char n;
-		const char *begin, *end;
-		char *ret;
-
-		str++;
-		if (!isdigit(c))
-			continue;
-		n = c - '0';
-
-		// We only handle one or two digits
-		if (isdigit(*str)) {
-			n = n*10 + *str - '0';
-			str++;
-		}
-
-		begin = end = str;
-		while ((c = *str) != 0) {
-			str++;
-			if (c == ',')
-				break;
-			end = str;
-		}
-
-		// Verify that it has the 'n=string' format and skip the equals sign
-		if (*begin != '=')
-			continue;
-		begin++;
-
-		// Is it the value we're looking for?
-		if (n != value)
-			continue;
-
-		ret = (char *)malloc(end - begin + 1);
-		if (!ret)
-			break;
-
-		memcpy(ret, begin, end-begin);
-		ret[end-begin] = 0;
-		return ret;
-	}
-	return NULL;
+	return desc->enums[value];
 }
 
 /*
@@ -651,8 +877,9 @@ static char *lookup_enum(const struct type_desc *desc, unsigned char value)
  */
 static void sample_event_state_type(const struct type_desc *desc, struct sample_data *info, unsigned char type)
 {
-	free(info->state_type);
-	info->state_type = lookup_enum(desc, type);
+	info->state_type = NULL;
+	if (DC_SAMPLE_WANTED(info->mask, DC_SAMPLE_EVENT))
+		info->state_type = lookup_enum(desc, type);
 }
 
 static void sample_event_state_value(const struct type_desc *desc, struct sample_data *info, unsigned char value)
@@ -674,8 +901,9 @@ static void sample_event_state_value(const struct type_desc *desc, struct sample
 
 static void sample_event_notify_type(const struct type_desc *desc, struct sample_data *info, unsigned char type)
 {
-	free(info->notify_type);
-	info->notify_type = lookup_enum(desc, type);
+	info->notify_type = NULL;
+	if (DC_SAMPLE_WANTED(info->mask, DC_SAMPLE_EVENT))
+		info->notify_type = lookup_enum(desc, type);
 }
 
 static void sample_event_notify_value(const struct type_desc *desc, struct sample_data *info, unsigned char value)
@@ -698,8 +926,9 @@ static void sample_event_notify_value(const struct type_desc *desc, struct sampl
 
 static void sample_event_warning_type(const struct type_desc *desc, struct sample_data *info, unsigned char type)
 {
-	free(info->warning_type);
-	info->warning_type = lookup_enum(desc, type);
+	info->warning_type = NULL;
+	if (DC_SAMPLE_WANTED(info->mask, DC_SAMPLE_EVENT))
+		info->warning_type = lookup_enum(desc, type);
 }
 
 static void sample_event_warning_value(const struct type_desc *desc, struct sample_data *info, unsigned char value)
@@ -721,8 +950,9 @@ static void sample_event_warning_value(const struct type_desc *desc, struct samp
 
 static void sample_event_alarm_type(const struct type_desc *desc, struct sample_data *info, unsigned char type)
 {
-	free(info->alarm_type);
-	info->alarm_type = lookup_enum(desc, type);
+	info->alarm_type = NULL;
+	if (DC_SAMPLE_WANTED(info->mask, DC_SAMPLE_EVENT))
+		info->alarm_type = lookup_enum(desc, type);
 }
 
 
@@ -747,27 +977,29 @@ static void sample_event_alarm_value(const struct type_desc *desc, struct sample
 static void sample_setpoint_type(const struct type_desc *desc, struct sample_data *info, unsigned char value)
 {
 	dc_sample_value_t sample = {0};
-	char *type = lookup_enum(desc, value);
+	const char *type;
+
+	if (!DC_SAMPLE_WANTED(info->mask, DC_SAMPLE_SETPOINT))
+		return;
 
+	type = lookup_enum(desc, value);
 	if (!type) {
 		DEBUG(info->eon->base.context, "sample_setpoint_type(%u) did not match anything in %s", value, desc->format);
 		return;
 	}
 
 	if (!strcasecmp(type, "Low"))
-		sample.ppo2 = info->eon->cache.lowsetpoint;
+		sample.ppo2 = info->eon->lowsetpoint;
 	else if (!strcasecmp(type, "High"))
-		sample.ppo2 = info->eon->cache.highsetpoint;
+		sample.ppo2 = info->eon->highsetpoint;
 	else if (!strcasecmp(type, "Custom"))
-		sample.ppo2 = info->eon->cache.customsetpoint;
+		sample.ppo2 = info->eon->customsetpoint;
 	else {
 		DEBUG(info->eon->base.context, "sample_setpoint_type(%u) unknown type '%s'", value, type);
-		free(type);
 		return;
 	}
 
 	if (info->callback) info->callback(DC_SAMPLE_SETPOINT, sample, info->userdata);
-	free(type);
 }
 
 // uint32
@@ -775,7 +1007,7 @@ static void sample_setpoint_po2(struct sample_data *info, unsigned int pressure)
 {
 	// I *think* this just sets the custom SP, and then
 	// we'll get a setpoint_type(2) later.
-	info->eon->cache.customsetpoint = pressure / 100000.0;	// Pascal to bar
+	info->eon->customsetpoint = pressure / 100000.0;	// Pascal to bar
 }
 
 static void sample_setpoint_automatic(struct sample_data *info, unsigned char value)
@@ -924,15 +1156,10 @@ static dc_status_t
 suunto_eonsteel_parser_samples_foreach(dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata)
 {
 	suunto_eonsteel_parser_t *eon = (suunto_eonsteel_parser_t *) abstract;
-	struct sample_data data = { eon, callback, userdata, 0 };
+	struct sample_data data = { eon, callback, userdata, abstract->samplemask, 0 };
 
 	traverse_data(eon, traverse_samples, &data);
 
-	free(data.state_type);
-	free(data.notify_type);
-	free(data.warning_type);
-	free(data.alarm_type);
-
 	return DC_STATUS_SUCCESS;
 }
 
@@ -974,7 +1201,7 @@ suunto_eonsteel_parser_get_field(dc_parser_t *parser, dc_field_type_t type, unsi
 		 * we get imperial or metric data - the only indication is
 		 * that metric is (at least so far) always whole liters
 		 */
-		tank->volume = eon->cache.tanksize[flags];
+		tank->volume = eon->tanksize[flags];
 		tank->gasmix = flags;
 
 		/*
@@ -984,8 +1211,8 @@ suunto_eonsteel_parser_get_field(dc_parser_t *parser, dc_field_type_t type, unsi
 		 * We report it as we get it and let the application figure out
 		 * what to do with that
 		 */
-		tank->workpressure = eon->cache.tankworkingpressure[flags];
-		tank->type = eon->cache.tankinfo[flags];
+		tank->workpressure = eon->tankworkingpressure[flags];
+		tank->type = eon->tankinfo[flags];
 
 		/*
 		 * See if we should call this imperial instead.
@@ -1059,7 +1286,7 @@ static dc_status_t add_gas_type(suunto_eonsteel_parser_t *eon, const struct type
 {
 	int idx = eon->cache.GASMIX_COUNT;
 	dc_tankinfo_t tankinfo = DC_TANKINFO_METRIC;
-	char *name;
+	const char *name;
 
 	if (idx >= MAXGASES)
 		return DC_STATUS_SUCCESS;
@@ -1077,11 +1304,10 @@ static dc_status_t add_gas_type(suunto_eonsteel_parser_t *eon, const struct type
 	else if (strcasecmp(name, "Primary"))
 		DEBUG(eon->base.context, "Unknown gas type %u (%s)", type, name);
 
-	eon->cache.tankinfo[idx] = tankinfo;
+	eon->tankinfo[idx] = tankinfo;
 
 	eon->cache.initialized |= 1 << DC_FIELD_GASMIX_COUNT;
 	eon->cache.initialized |= 1 << DC_FIELD_TANK_COUNT;
-	free(name);
 	return DC_STATUS_SUCCESS;
 }
 
@@ -1111,7 +1337,7 @@ static dc_status_t add_gas_size(suunto_eonsteel_parser_t *eon, float l)
 {
 	int idx = eon->cache.GASMIX_COUNT-1;
 	if (idx >= 0)
-		eon->cache.tanksize[idx] = l;
+		eon->tanksize[idx] = l;
 	eon->cache.initialized |= 1 << DC_FIELD_TANK;
 	return DC_STATUS_SUCCESS;
 }
@@ -1120,7 +1346,7 @@ static dc_status_t add_gas_workpressure(suunto_eonsteel_parser_t *eon, float wp)
 {
 	int idx = eon->cache.GASMIX_COUNT-1;
 	if (idx >= 0)
-		eon->cache.tankworkingpressure[idx] = wp;
+		eon->tankworkingpressure[idx] = wp;
 	return DC_STATUS_SUCCESS;
 }
 
@@ -1288,13 +1514,13 @@ static dc_status_t traverse_diving_fields(suunto_eonsteel_parser_t *eon,
 
 	if (!strcmp(name, "LowSetPoint")) {
 		unsigned int pressure = array_uint32_le(data); // in SI units - Pascal
-		eon->cache.lowsetpoint = pressure / 100000.0; // bar
+		eon->lowsetpoint = pressure / 100000.0; // bar
 		return 0;
 	}
 
 	if (!strcmp(name, "HighSetPoint")) {
 		unsigned int pressure = array_uint32_le(data); // in SI units - Pascal
-		eon->cache.highsetpoint = pressure / 100000.0; // bar
+		eon->highsetpoint = pressure / 100000.0; // bar
 		return 0;
 	}
 
@@ -1406,7 +1632,6 @@ static int traverse_fields(unsigned short type, const struct type_desc *desc, co
 
 static void initialize_field_caches(suunto_eonsteel_parser_t *eon)
 {
-	memset(&eon->cache, 0, sizeof(eon->cache));
 	eon->cache.initialized = 1 << DC_FIELD_DIVETIME;
 
 	traverse_data(eon, traverse_fields, eon);
@@ -1442,14 +1667,18 @@ static void show_all_descriptors(suunto_eonsteel_parser_t *eon)
 }
 
 static dc_status_t
-suunto_eonsteel_parser_set_data(dc_parser_t *parser, const unsigned char *data, unsigned int size)
+suunto_eonsteel_parser_reset(dc_parser_t *parser)
 {
 	suunto_eonsteel_parser_t *eon = (suunto_eonsteel_parser_t *) parser;
 
-	desc_free(eon->type_desc, MAXTYPE);
-	memset(eon->type_desc, 0, sizeof(eon->type_desc));
-	initialize_field_caches(eon);
-	show_all_descriptors(eon);
+	desc_clear(eon->type_desc, MAXTYPE);
+	dc_field_clear(&eon->cache);
+	eon->lowsetpoint = 0.0;
+	eon->highsetpoint = 0.0;
+	eon->customsetpoint = 0.0;
+	memset(eon->tankinfo, 0, sizeof(eon->tankinfo));
+	memset(eon->tanksize, 0, sizeof(eon->tanksize));
+	memset(eon->tankworkingpressure, 0, sizeof(eon->tankworkingpressure));
 	return DC_STATUS_SUCCESS;
 }
 
@@ -1459,7 +1688,17 @@ suunto_eonsteel_parser_destroy(dc_parser_t *parser)
 	suunto_eonsteel_parser_t *eon = (suunto_eonsteel_parser_t *) parser;
 
 	desc_free(eon->type_desc, MAXTYPE);
+	dc_field_free(&eon->cache);
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+suunto_eonsteel_parser_set_data(dc_parser_t *parser, const unsigned char *data, unsigned int size)
+{
+	suunto_eonsteel_parser_t *eon = (suunto_eonsteel_parser_t *) parser;
 
+	initialize_field_caches(eon);
+	show_all_descriptors(eon);
 	return DC_STATUS_SUCCESS;
 }
 
@@ -1467,9 +1706,12 @@ static const dc_parser_vtable_t suunto_eonsteel_parser_vtable = {
 	sizeof(suunto_eonsteel_parser_t),
 	DC_FAMILY_SUUNTO_EONSTEEL,
 	suunto_eonsteel_parser_set_data, /* set_data */
+	suunto_eonsteel_parser_reset, /* reset */
 	suunto_eonsteel_parser_get_datetime, /* datetime */
 	suunto_eonsteel_parser_get_field, /* fields */
+	NULL, /* summary */
 	suunto_eonsteel_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	suunto_eonsteel_parser_destroy /* destroy */
 };
 
@@ -1489,6 +1731,12 @@ suunto_eonsteel_parser_create(dc_parser_t **out, dc_context_t *context, unsigned
 
 	memset(&parser->type_desc, 0, sizeof(parser->type_desc));
 	memset(&parser->cache, 0, sizeof(parser->cache));
+	parser->lowsetpoint = 0.0;
+	parser->highsetpoint = 0.0;
+	parser->customsetpoint = 0.0;
+	memset(parser->tankinfo, 0, sizeof(parser->tankinfo));
+	memset(parser->tanksize, 0, sizeof(parser->tanksize));
+	memset(parser->tankworkingpressure, 0, sizeof(parser->tankworkingpressure));
 
 	*out = (dc_parser_t *) parser;
 
@@ -40,6 +40,7 @@ struct suunto_solution_parser_t {
 };
 
 static dc_status_t suunto_solution_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t suunto_solution_parser_reset (dc_parser_t *abstract);
 static dc_status_t suunto_solution_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t suunto_solution_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
 
@@ -47,9 +48,12 @@ static const dc_parser_vtable_t suunto_solution_parser_vtable = {
 	sizeof(suunto_solution_parser_t),
 	DC_FAMILY_SUUNTO_SOLUTION,
 	suunto_solution_parser_set_data, /* set_data */
+	suunto_solution_parser_reset, /* reset */
 	NULL, /* datetime */
 	suunto_solution_parser_get_field, /* fields */
+	NULL, /* summary */
 	suunto_solution_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -81,7 +85,7 @@ suunto_solution_parser_create (dc_parser_t **out, dc_context_t *context)
 
 
 static dc_status_t
-suunto_solution_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+suunto_solution_parser_reset (dc_parser_t *abstract)
 {
 	suunto_solution_parser_t *parser = (suunto_solution_parser_t *) abstract;
 
@@ -93,6 +97,12 @@ suunto_solution_parser_set_data (dc_parser_t *abstract, const unsigned char *dat
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+suunto_solution_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
 
 static dc_status_t
 suunto_solution_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
@@ -45,6 +45,7 @@ struct suunto_vyper_parser_t {
 };
 
 static dc_status_t suunto_vyper_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t suunto_vyper_parser_reset (dc_parser_t *abstract);
 static dc_status_t suunto_vyper_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t suunto_vyper_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
 static dc_status_t suunto_vyper_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
@@ -53,9 +54,12 @@ static const dc_parser_vtable_t suunto_vyper_parser_vtable = {
 	sizeof(suunto_vyper_parser_t),
 	DC_FAMILY_SUUNTO_VYPER,
 	suunto_vyper_parser_set_data, /* set_data */
+	suunto_vyper_parser_reset, /* reset */
 	suunto_vyper_parser_get_datetime, /* datetime */
 	suunto_vyper_parser_get_field, /* fields */
+	NULL, /* summary */
 	suunto_vyper_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -190,7 +194,7 @@ suunto_vyper_parser_create (dc_parser_t **out, dc_context_t *context)
 
 
 static dc_status_t
-suunto_vyper_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+suunto_vyper_parser_reset (dc_parser_t *abstract)
 {
 	suunto_vyper_parser_t *parser = (suunto_vyper_parser_t *) abstract;
 
@@ -207,6 +211,12 @@ suunto_vyper_parser_set_data (dc_parser_t *abstract, const unsigned char *data,
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+suunto_vyper_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
 
 static dc_status_t
 suunto_vyper_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
@@ -45,9 +45,12 @@ static const dc_parser_vtable_t tecdiving_divecomputereu_parser_vtable = {
 	sizeof(tecdiving_divecomputereu_parser_t),
 	DC_FAMILY_TECDIVING_DIVECOMPUTEREU,
 	tecdiving_divecomputereu_parser_set_data, /* set_data */
+	NULL, /* reset */
 	tecdiving_divecomputereu_parser_get_datetime, /* datetime */
 	tecdiving_divecomputereu_parser_get_field, /* fields */
+	NULL, /* summary */
 	tecdiving_divecomputereu_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -0,0 +1,405 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#if defined (_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOGDI
+#include <windows.h>
+#define HAVE_THREADS
+#elif defined (HAVE_PTHREAD_H)
+#include <pthread.h>
+#include <unistd.h>
+#define HAVE_THREADS
+#endif
+
+#include "thread.h"
+#include "context-private.h"
+
+struct dc_mutex_t {
+#if defined (_WIN32)
+	CRITICAL_SECTION handle;
+#elif defined (HAVE_THREADS)
+	pthread_mutex_t handle;
+#else
+	int dummy;
+#endif
+};
+
+struct dc_cond_t {
+#if defined (_WIN32)
+	CONDITION_VARIABLE handle;
+#elif defined (HAVE_THREADS)
+	pthread_cond_t handle;
+#else
+	int dummy;
+#endif
+};
+
+struct dc_thread_t {
+#if defined (_WIN32)
+	HANDLE handle;
+#elif defined (HAVE_THREADS)
+	pthread_t handle;
+#endif
+	dc_thread_func_t func;
+	void *userdata;
+};
+
+dc_status_t
+dc_mutex_new (dc_mutex_t **out)
+{
+	dc_mutex_t *mutex = NULL;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	mutex = (dc_mutex_t *) malloc (sizeof (dc_mutex_t));
+	if (mutex == NULL) {
+		return DC_STATUS_NOMEMORY;
+	}
+
+#if defined (_WIN32)
+	InitializeCriticalSection (&mutex->handle);
+#elif defined (HAVE_THREADS)
+	if (pthread_mutex_init (&mutex->handle, NULL) != 0) {
+		free (mutex);
+		return DC_STATUS_NOMEMORY;
+	}
+#endif
+
+	*out = mutex;
+
+	return DC_STATUS_SUCCESS;
+}
+
+void
+dc_mutex_lock (dc_mutex_t *mutex)
+{
+	if (mutex == NULL)
+		return;
+
+#if defined (_WIN32)
+	EnterCriticalSection (&mutex->handle);
+#elif defined (HAVE_THREADS)
+	pthread_mutex_lock (&mutex->handle);
+#endif
+}
+
+void
+dc_mutex_unlock (dc_mutex_t *mutex)
+{
+	if (mutex == NULL)
+		return;
+
+#if defined (_WIN32)
+	LeaveCriticalSection (&mutex->handle);
+#elif defined (HAVE_THREADS)
+	pthread_mutex_unlock (&mutex->handle);
+#endif
+}
+
+void
+dc_mutex_free (dc_mutex_t *mutex)
+{
+	if (mutex == NULL)
+		return;
+
+#if defined (_WIN32)
+	DeleteCriticalSection (&mutex->handle);
+#elif defined (HAVE_THREADS)
+	pthread_mutex_destroy (&mutex->handle);
+#endif
+
+	free (mutex);
+}
+
+dc_status_t
+dc_cond_new (dc_cond_t **out)
+{
+	dc_cond_t *cond = NULL;
+
+	if (out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	cond = (dc_cond_t *) malloc (sizeof (dc_cond_t));
+	if (cond == NULL) {
+		return DC_STATUS_NOMEMORY;
+	}
+
+#if defined (_WIN32)
+	InitializeConditionVariable (&cond->handle);
+#elif defined (HAVE_THREADS)
+	if (pthread_cond_init (&cond->handle, NULL) != 0) {
+		free (cond);
+		return DC_STATUS_NOMEMORY;
+	}
+#endif
+
+	*out = cond;
+
+	return DC_STATUS_SUCCESS;
+}
+
+void
+dc_cond_wait (dc_cond_t *cond, dc_mutex_t *mutex)
+{
+	if (cond == NULL || mutex == NULL)
+		return;
+
+#if defined (_WIN32)
+	SleepConditionVariableCS (&cond->handle, &mutex->handle, INFINITE);
+#elif defined (HAVE_THREADS)
+	pthread_cond_wait (&cond->handle, &mutex->handle);
+#endif
+}
+
+void
+dc_cond_signal (dc_cond_t *cond)
+{
+	if (cond == NULL)
+		return;
+
+#if defined (_WIN32)
+	WakeConditionVariable (&cond->handle);
+#elif defined (HAVE_THREADS)
+	pthread_cond_signal (&cond->handle);
+#endif
+}
+
+void
+dc_cond_broadcast (dc_cond_t *cond)
+{
+	if (cond == NULL)
+		return;
+
+#if defined (_WIN32)
+	WakeAllConditionVariable (&cond->handle);
+#elif defined (HAVE_THREADS)
+	pthread_cond_broadcast (&cond->handle);
+#endif
+}
+
+void
+dc_cond_free (dc_cond_t *cond)
+{
+	if (cond == NULL)
+		return;
+
+#if !defined (_WIN32) && defined (HAVE_THREADS)
+	pthread_cond_destroy (&cond->handle);
+#endif
+
+	free (cond);
+}
+
+#if defined (_WIN32)
+static DWORD WINAPI
+dc_thread_main (LPVOID arg)
+{
+	dc_thread_t *thread = (dc_thread_t *) arg;
+	thread->func (thread->userdata);
+	return 0;
+}
+#elif defined (HAVE_THREADS)
+static void *
+dc_thread_main (void *arg)
+{
+	dc_thread_t *thread = (dc_thread_t *) arg;
+	thread->func (thread->userdata);
+	return NULL;
+}
+#endif
+
+dc_status_t
+dc_thread_new (dc_thread_t **out, dc_thread_func_t func, void *userdata)
+{
+#ifdef HAVE_THREADS
+	dc_thread_t *thread = NULL;
+
+	if (out == NULL || func == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	thread = (dc_thread_t *) malloc (sizeof (dc_thread_t));
+	if (thread == NULL) {
+		return DC_STATUS_NOMEMORY;
+	}
+
+	thread->func = func;
+	thread->userdata = userdata;
+
+#if defined (_WIN32)
+	thread->handle = CreateThread (NULL, 0, dc_thread_main, thread, 0, NULL);
+	if (thread->handle == NULL) {
+		free (thread);
+		return DC_STATUS_NOMEMORY;
+	}
+#else
+	if (pthread_create (&thread->handle, NULL, dc_thread_main, thread) != 0) {
+		free (thread);
+		return DC_STATUS_NOMEMORY;
+	}
+#endif
+
+	*out = thread;
+
+	return DC_STATUS_SUCCESS;
+#else
+	UNUSED(out);
+	UNUSED(func);
+	UNUSED(userdata);
+	return DC_STATUS_UNSUPPORTED;
+#endif
+}
+
+dc_status_t
+dc_thread_join (dc_thread_t *thread)
+{
+	if (thread == NULL)
+		return DC_STATUS_SUCCESS;
+
+#if defined (_WIN32)
+	WaitForSingleObject (thread->handle, INFINITE);
+	CloseHandle (thread->handle);
+#elif defined (HAVE_THREADS)
+	pthread_join (thread->handle, NULL);
+#endif
+
+	free (thread);
+
+	return DC_STATUS_SUCCESS;
+}
+
+unsigned int
+dc_thread_ncpus (void)
+{
+	long n = 1;
+
+#if defined (_WIN32)
+	SYSTEM_INFO info;
+	GetSystemInfo (&info);
+	n = info.dwNumberOfProcessors;
+#elif defined (HAVE_THREADS) && defined (_SC_NPROCESSORS_ONLN)
+	n = sysconf (_SC_NPROCESSORS_ONLN);
+#endif
+
+	if (n < 1)
+		n = 1;
+
+	return (unsigned int) n;
+}
+
+#if !defined (_WIN32) && !defined (__GNUC__) && defined (HAVE_THREADS)
+static pthread_mutex_t g_atomic = PTHREAD_MUTEX_INITIALIZER;
+#define ATOMIC_LOCK() pthread_mutex_lock (&g_atomic)
+#define ATOMIC_UNLOCK() pthread_mutex_unlock (&g_atomic)
+#else
+#define ATOMIC_LOCK()
+#define ATOMIC_UNLOCK()
+#endif
+
+long
+dc_atomic_load (dc_atomic_t *atomic)
+{
+#if defined (__GNUC__)
+	return __atomic_load_n (atomic, __ATOMIC_SEQ_CST);
+#elif defined (_WIN32)
+	return InterlockedCompareExchange (atomic, 0, 0);
+#else
+	long value;
+	ATOMIC_LOCK ();
+	value = *atomic;
+	ATOMIC_UNLOCK ();
+	return value;
+#endif
+}
+
+void
+dc_atomic_store (dc_atomic_t *atomic, long value)
+{
+#if defined (__GNUC__)
+	__atomic_store_n (atomic, value, __ATOMIC_SEQ_CST);
+#elif defined (_WIN32)
+	InterlockedExchange (atomic, value);
+#else
+	ATOMIC_LOCK ();
+	*atomic = value;
+	ATOMIC_UNLOCK ();
+#endif
+}
+
+long
+dc_atomic_add (dc_atomic_t *atomic, long value)
+{
+#if defined (__GNUC__)
+	return __atomic_fetch_add (atomic, value, __ATOMIC_SEQ_CST);
+#elif defined (_WIN32)
+	return InterlockedExchangeAdd (atomic, value);
+#else
+	long previous;
+	ATOMIC_LOCK ();
+	previous = *atomic;
+	*atomic = previous + value;
+	ATOMIC_UNLOCK ();
+	return previous;
+#endif
+}
+
+long
+dc_atomic_exchange (dc_atomic_t *atomic, long value)
+{
+#if defined (__GNUC__)
+	return __atomic_exchange_n (atomic, value, __ATOMIC_SEQ_CST);
+#elif defined (_WIN32)
+	return InterlockedExchange (atomic, value);
+#else
+	long previous;
+	ATOMIC_LOCK ();
+	previous = *atomic;
+	*atomic = value;
+	ATOMIC_UNLOCK ();
+	return previous;
+#endif
+}
+
+int
+dc_atomic_cas (dc_atomic_t *atomic, long expected, long desired)
+{
+#if defined (__GNUC__)
+	return __atomic_compare_exchange_n (atomic, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#elif defined (_WIN32)
+	return InterlockedCompareExchange (atomic, desired, expected) == expected;
+#else
+	int result = 0;
+	ATOMIC_LOCK ();
+	if (*atomic == expected) {
+		*atomic = desired;
+		result = 1;
+	}
+	ATOMIC_UNLOCK ();
+	return result;
+#endif
+}
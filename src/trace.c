@@ -0,0 +1,107 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "trace.h"
+#include "array.h"
+
+static const unsigned char g_magic[4] = {'D', 'C', 'T', 'R'};
+
+dc_status_t
+dc_trace_write_header (FILE *fp)
+{
+	unsigned char header[DC_TRACE_HEADERSIZE];
+
+	memcpy (header, g_magic, sizeof (g_magic));
+	array_uint32_le_set (header + 4, DC_TRACE_VERSION);
+
+	if (fwrite (header, sizeof (header), 1, fp) != 1)
+		return DC_STATUS_IO;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_trace_write_record (FILE *fp, const dc_trace_record_t *record)
+{
+	unsigned char header[DC_TRACE_RECORDSIZE];
+
+	array_uint32_le_set (header + 0, record->timestamp & 0xFFFFFFFF);
+	array_uint32_le_set (header + 4, (record->timestamp >> 32) & 0xFFFFFFFF);
+	array_uint32_le_set (header + 8, record->size);
+	array_uint32_le_set (header + 12, record->request);
+	array_uint16_le_set (header + 16, record->transport);
+	header[18] = record->type;
+	header[19] = (unsigned char) (signed char) record->status;
+
+	if (fwrite (header, sizeof (header), 1, fp) != 1)
+		return DC_STATUS_IO;
+
+	if (record->size && fwrite (record->data, record->size, 1, fp) != 1)
+		return DC_STATUS_IO;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_trace_check_header (const unsigned char data[], size_t size)
+{
+	if (size < DC_TRACE_HEADERSIZE || memcmp (data, g_magic, sizeof (g_magic)) != 0)
+		return DC_STATUS_DATAFORMAT;
+
+	if (array_uint32_le (data + 4) != DC_TRACE_VERSION)
+		return DC_STATUS_UNSUPPORTED;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_trace_read_record (const unsigned char data[], size_t size, size_t *offset, dc_trace_record_t *record)
+{
+	size_t pos = *offset;
+
+	if (pos == size)
+		return DC_STATUS_DONE;
+
+	if (pos + DC_TRACE_RECORDSIZE > size)
+		return DC_STATUS_DATAFORMAT;
+
+	const unsigned char *header = data + pos;
+	record->timestamp = array_uint32_le (header + 0) |
+		(dc_usecs_t) array_uint32_le (header + 4) << 32;
+	record->size = array_uint32_le (header + 8);
+	record->request = array_uint32_le (header + 12);
+	record->transport = (dc_transport_t) array_uint16_le (header + 16);
+	record->type = (dc_trace_t) header[18];
+	record->status = (dc_status_t) (signed char) header[19];
+	pos += DC_TRACE_RECORDSIZE;
+
+	if (record->size > size - pos)
+		return DC_STATUS_DATAFORMAT;
+
+	record->data = data + pos;
+	pos += record->size;
+
+	*offset = pos;
+
+	return DC_STATUS_SUCCESS;
+}
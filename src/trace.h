@@ -0,0 +1,76 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_TRACE_H
+#define DC_TRACE_H
+
+#include <stdio.h>
+
+#include <libdivecomputer/common.h>
+#include <libdivecomputer/context.h>
+
+#include "timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Encoding and decoding of the binary trace format. The format itself
+ * is documented with dc_context_set_tracefile().
+ */
+
+#define DC_TRACE_HEADERSIZE 8
+#define DC_TRACE_RECORDSIZE 20
+#define DC_TRACE_VERSION 1
+
+typedef struct dc_trace_record_t {
+	dc_usecs_t timestamp;
+	dc_trace_t type;
+	dc_transport_t transport;
+	unsigned int request;
+	dc_status_t status;
+	const unsigned char *data;
+	unsigned int size;
+} dc_trace_record_t;
+
+dc_status_t
+dc_trace_write_header (FILE *fp);
+
+dc_status_t
+dc_trace_write_record (FILE *fp, const dc_trace_record_t *record);
+
+dc_status_t
+dc_trace_check_header (const unsigned char data[], size_t size);
+
+/*
+ * Decode the record at the given offset in an in-memory trace file,
+ * and advance the offset to the next record. Returns DC_STATUS_DONE at
+ * the end of the data, and DC_STATUS_DATAFORMAT for a truncated record.
+ * The record data points into the input buffer.
+ */
+dc_status_t
+dc_trace_read_record (const unsigned char data[], size_t size, size_t *offset, dc_trace_record_t *record);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_TRACE_H */
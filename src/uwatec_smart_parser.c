@@ -161,8 +161,10 @@ struct uwatec_smart_parser_t {
 };
 
 static dc_status_t uwatec_smart_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size);
+static dc_status_t uwatec_smart_parser_reset (dc_parser_t *abstract);
 static dc_status_t uwatec_smart_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
 static dc_status_t uwatec_smart_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value);
+static dc_status_t uwatec_smart_parser_get_summary (dc_parser_t *abstract, dc_summary_t *summary);
 static dc_status_t uwatec_smart_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t callback, void *userdata);
 
 static dc_status_t uwatec_smart_parse (uwatec_smart_parser_t *parser, dc_sample_callback_t callback, void *userdata);
@@ -171,9 +173,12 @@ static const dc_parser_vtable_t uwatec_smart_parser_vtable = {
 	sizeof(uwatec_smart_parser_t),
 	DC_FAMILY_UWATEC_SMART,
 	uwatec_smart_parser_set_data, /* set_data */
+	uwatec_smart_parser_reset, /* reset */
 	uwatec_smart_parser_get_datetime, /* datetime */
 	uwatec_smart_parser_get_field, /* fields */
+	uwatec_smart_parser_get_summary, /* summary */
 	uwatec_smart_parser_samples_foreach, /* samples_foreach */
+	NULL, /* samples_batch */
 	NULL /* destroy */
 };
 
@@ -708,7 +713,7 @@ error_free:
 
 
 static dc_status_t
-uwatec_smart_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+uwatec_smart_parser_reset (dc_parser_t *abstract)
 {
 	uwatec_smart_parser_t *parser = (uwatec_smart_parser_t *) abstract;
 
@@ -731,6 +736,12 @@ uwatec_smart_parser_set_data (dc_parser_t *abstract, const unsigned char *data,
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+uwatec_smart_parser_set_data (dc_parser_t *abstract, const unsigned char *data, unsigned int size)
+{
+	return DC_STATUS_SUCCESS;
+}
+
 
 static dc_status_t
 uwatec_smart_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime)
@@ -769,23 +780,16 @@ uwatec_smart_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime
 }
 
 
+/*
+ * Get a field value. Everything is available from the header table,
+ * except for the gas mixes and tanks, which are only complete once the
+ * profile is cached too.
+ */
 static dc_status_t
-uwatec_smart_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
+uwatec_smart_parser_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
 {
 	uwatec_smart_parser_t *parser = (uwatec_smart_parser_t *) abstract;
 
-	// Cache the parser data.
-	dc_status_t rc = uwatec_smart_parser_cache (parser);
-	if (rc != DC_STATUS_SUCCESS)
-		return rc;
-
-	// Cache the profile data.
-	if (parser->cached < PROFILE) {
-		rc = uwatec_smart_parse (parser, NULL, NULL);
-		if (rc != DC_STATUS_SUCCESS)
-			return rc;
-	}
-
 	const uwatec_smart_header_info_t *table = parser->header;
 	const unsigned char *data = abstract->data;
 
@@ -855,6 +859,41 @@ uwatec_smart_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsi
 }
 
 
+static dc_status_t
+uwatec_smart_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
+{
+	uwatec_smart_parser_t *parser = (uwatec_smart_parser_t *) abstract;
+
+	// Cache the parser data.
+	dc_status_t rc = uwatec_smart_parser_cache (parser);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	// Cache the profile data.
+	if (parser->cached < PROFILE) {
+		rc = uwatec_smart_parse (parser, NULL, NULL);
+		if (rc != DC_STATUS_SUCCESS)
+			return rc;
+	}
+
+	return uwatec_smart_parser_field (abstract, type, flags, value);
+}
+
+
+static dc_status_t
+uwatec_smart_parser_get_summary (dc_parser_t *abstract, dc_summary_t *summary)
+{
+	uwatec_smart_parser_t *parser = (uwatec_smart_parser_t *) abstract;
+
+	// Cache the parser data.
+	dc_status_t rc = uwatec_smart_parser_cache (parser);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	return dc_parser_fill_summary (abstract, uwatec_smart_parser_field, summary);
+}
+
+
 static unsigned int
 uwatec_smart_identify (const unsigned char data[], unsigned int size)
 {